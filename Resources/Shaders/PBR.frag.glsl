@@ -177,7 +177,9 @@ void main() {
 	PBR.N = normalize(In.NormalMat[2]);
 	if (Material.NormalUV >= 0) {
 		vec2 uvNormal = (mat3(Material.NormalTransform) * vec3(Material.NormalUV == 0 ? In.UV0 : In.UV1, 1)).xy;
-		PBR.N = normalize(textureLod(nonuniformEXT(sampler2D(BindlessTextures[Material.NormalIndex], BindlessSampler)), uvNormal, 0).rgb * 2.0f - 1.0f);
+		// Only X and Y are read, so that two-channel (BC5) normal maps work too. Z is always positive in tangent space.
+		vec2 normalXY = textureLod(nonuniformEXT(sampler2D(BindlessTextures[Material.NormalIndex], BindlessSampler)), uvNormal, 0).rg * 2.0f - 1.0f;
+		PBR.N = vec3(normalXY, sqrt(max(1.0f - dot(normalXY, normalXY), 0.0f)));
 		PBR.N = normalize(In.NormalMat * PBR.N);
 	}
 	vec3 V = normalize(Scene.ViewPosition.xyz - In.WorldPos);
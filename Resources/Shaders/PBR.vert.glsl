@@ -1,7 +1,7 @@
 #version 460 core
 
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+layout(location = 1) in vec2 inNormal; // Octahedral-encoded.
 layout(location = 2) in vec4 inTangent;
 layout(location = 3) in vec2 inUV0;
 layout(location = 4) in vec2 inUV1;
@@ -36,6 +36,15 @@ struct VertexOut {
 
 layout(location = 0) out VertexOut Out;
 
+vec3 OctDecode(vec2 f) {
+	vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+
+	return normalize(n);
+}
+
 void main() {
 	mat4 model;
 	if (PC.Skinned) {
@@ -51,9 +60,10 @@ void main() {
 
 	vec4 locPos = model * vec4(inPosition, 1.0f);
 	mat3 normalMatrix = mat3(model);
+	vec3 normal = OctDecode(inNormal);
 	vec3 T = normalize(normalMatrix * inTangent.xyz);
-	vec3 B = normalize(normalMatrix * (cross(inNormal.xyz, inTangent.xyz) * inTangent.w));
-	vec3 N = normalize(normalMatrix * inNormal);
+	vec3 B = normalize(normalMatrix * (cross(normal, inTangent.xyz) * inTangent.w));
+	vec3 N = normalize(normalMatrix * normal);
 
 	Out.WorldPos = locPos.xyz / locPos.w;
 	Out.UV0 = inUV0;
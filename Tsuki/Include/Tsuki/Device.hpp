@@ -34,6 +34,9 @@ class Device : public IntrusivePtrEnabled<Device, std::default_delete<Device>, H
 	friend struct SemaphoreDeleter;
 	friend class WSI;
 
+	// The number of threads which can record command buffers at the same time, each with its own command pools.
+	static constexpr uint32_t MaxThreads = 2;
+
 	Device(const Context& context);
 	Device(const Device&)            = delete;
 	Device& operator=(const Device&) = delete;
@@ -87,6 +90,11 @@ class Device : public IntrusivePtrEnabled<Device, std::default_delete<Device>, H
 	CommandBufferHandle RequestCommandBufferForThread(uint32_t threadIndex,
 	                                                  CommandBufferType type = CommandBufferType::Generic);
 
+	// Set the index of the calling thread, used to pick the command pools its command buffers come from. Threads start
+	// at index 0. Every thread which requests command buffers while another is also doing so must use a different index,
+	// below MaxThreads.
+	static void SetThreadIndex(uint32_t threadIndex);
+
 	uint64_t AllocateCookie();
 	void AddWaitSemaphore(CommandBufferType cbType, SemaphoreHandle semaphore, vk::PipelineStageFlags stages, bool flush);
 	void EndFrame();
@@ -113,6 +113,10 @@ struct ImageCreateInfo {
 	vk::ImageCreateFlags Flags = {};
 	ImageCreateFlags MiscFlags = {};
 
+	// Applied by the image's default view, so that images storing fewer channels can still be sampled as RGBA. Render
+	// target views always use the identity.
+	vk::ComponentMapping Swizzle = {};
+
 	vk::ImageViewType GetImageViewType() const;
 
 	static ImageCreateInfo Immutable2D(uint32_t width, uint32_t height, vk::Format format, bool mipmaps = false) {
@@ -78,8 +78,7 @@ DescriptorSetAllocator::DescriptorSetAllocator(Hash hash,
 	vk::DescriptorSetLayoutCreateInfo layoutCI;
 
 	if (!_bindless) {
-		// const uint32_t threadCount = Threading::Get()->GetThreadCount();
-		const uint32_t threadCount = 1;
+		const uint32_t threadCount = Device::MaxThreads;
 		for (uint32_t i = 0; i < threadCount; ++i) { _perThread.emplace_back(new PerThread()); }
 	}
 
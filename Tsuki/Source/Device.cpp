@@ -20,8 +20,10 @@
 #include "Log.hpp"
 
 #ifdef TSUKI_VULKAN_MT
+static thread_local uint32_t ThreadIndex = 0;
+
 static uint32_t GetThreadIndex() {
-	return 0;
+	return ThreadIndex;
 }
 #	define DeviceLock() std::lock_guard<std::mutex> lock(_lock.Mutex)
 #	define DeviceFlush()                                                 \
@@ -407,7 +409,7 @@ ImageHandle Device::CreateImage(const ImageCreateInfo& imageCI, const ImageIniti
 			image,
 			tmpCI.GetImageViewType(),
 			imageCI.Format,
-			vk::ComponentMapping(),
+			imageCI.Swizzle,
 			vk::ImageSubresourceRange(FormatToAspect(tmpCI.Format), 0, tmpCI.MipLevels, 0, tmpCI.ArrayLayers));
 		viewType = defaultViewCI.viewType;
 
@@ -442,6 +444,7 @@ ImageHandle Device::CreateImage(const ImageCreateInfo& imageCI, const ImageIniti
 			    ((defaultViewCI.subresourceRange.levelCount > 1) || (defaultViewCI.subresourceRange.layerCount > 1))) {
 				auto viewCI                        = defaultViewCI;
 				viewCI.viewType                    = vk::ImageViewType::e2D;
+				viewCI.components                  = vk::ComponentMapping();
 				viewCI.subresourceRange.levelCount = 1;
 				viewCI.subresourceRange.layerCount = 1;
 
@@ -863,6 +866,13 @@ CommandBufferHandle Device::RequestCommandBuffer(CommandBufferType type) {
 	return RequestCommandBufferForThread(GetThreadIndex(), type);
 }
 
+void Device::SetThreadIndex(uint32_t threadIndex) {
+	assert(threadIndex < MaxThreads);
+#ifdef TSUKI_VULKAN_MT
+	ThreadIndex = threadIndex;
+#endif
+}
+
 CommandBufferHandle Device::RequestCommandBufferForThread(uint32_t threadIndex, CommandBufferType type) {
 	DeviceLock();
 	return RequestCommandBufferNoLock(threadIndex, type);
@@ -1512,7 +1522,7 @@ void Device::WaitIdleNoLock() {
 }
 
 Device::FrameContext::FrameContext(Device& device, uint32_t index) : Parent(device), Index(index) {
-	const auto threadCount = 1;
+	const int threadCount = MaxThreads;
 	for (int i = 0; i < QueueTypeCount; ++i) {
 		CommandPools[i].reserve(threadCount);
 		TimelineSemaphores[i] = device._queueData[i].TimelineSemaphore;
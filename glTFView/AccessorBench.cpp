@@ -0,0 +1,126 @@
+// Microbenchmark for the accessor conversion kernels. Each case is converted both with the kernels and with the
+// per-component conversion Model.cpp used to do for every accessor, the results are checked to be identical, and the
+// throughput of both is reported.
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AccessorKernels.hpp"
+
+// The original conversion, kept here as the baseline to compare against.
+template <typename Source, typename D>
+static void ReferenceConvert(
+	const uint8_t* bufferData, size_t byteStride, bool normalized, size_t dstCount, size_t count, D* dst) {
+	constexpr Source srcMax  = std::numeric_limits<Source>::max();
+	constexpr bool srcSigned = std::numeric_limits<Source>::is_signed;
+	constexpr auto srcSize   = sizeof(Source);
+
+	auto Get = [bufferData, byteStride, normalized](size_t attributeIndex, uint8_t componentIndex) -> D {
+		const uint8_t* dataPtr = bufferData + (attributeIndex * byteStride) + (componentIndex * srcSize);
+		const Source v         = *reinterpret_cast<const Source*>(dataPtr);
+
+		if (normalized) {
+			if (srcSigned) {
+				return std::max(static_cast<D>(v) / static_cast<D>(srcMax), static_cast<D>(-1.0));
+			} else {
+				return static_cast<D>(v) / static_cast<D>(srcMax);
+			}
+		} else {
+			return static_cast<D>(v);
+		}
+	};
+
+	for (size_t i = 0; i < count; ++i) {
+		for (size_t c = 0; c < dstCount; ++c) { dst[i * dstCount + c] = Get(i, c); }
+	}
+}
+
+static volatile double benchSink = 0.0;
+
+template <typename T>
+static void DoNotOptimize(const T* data) {
+	benchSink = static_cast<double>(data[0]);
+}
+
+template <typename Func>
+static double TimeBest(Func&& func) {
+	double best = std::numeric_limits<double>::max();
+	for (int i = 0; i < 10; ++i) {
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		const auto end = std::chrono::high_resolution_clock::now();
+		best           = std::min(best, std::chrono::duration<double>(end - start).count());
+	}
+
+	return best;
+}
+
+static bool failed = false;
+
+template <typename Source, typename D>
+static void RunCase(const std::string& name, size_t components, size_t byteStride, bool normalized, size_t count) {
+	std::mt19937 rng(1234);
+	std::vector<uint8_t> src(count * byteStride);
+	for (auto& b : src) { b = static_cast<uint8_t>(rng()); }
+	if constexpr (std::is_same_v<Source, float>) {
+		std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+		for (size_t i = 0; i < count * byteStride / sizeof(float); ++i) {
+			const float f = dist(rng);
+			memcpy(src.data() + i * sizeof(float), &f, sizeof(f));
+		}
+	}
+
+	std::vector<D> expected(count * components);
+	std::vector<D> actual(count * components);
+	const double timeReference = TimeBest([&]() {
+		ReferenceConvert<Source, D>(src.data(), byteStride, normalized, components, count, expected.data());
+		DoNotOptimize(expected.data());
+	});
+	const double timeKernel = TimeBest([&]() {
+		if constexpr (std::is_same_v<D, float>) {
+			ConvertComponentsToFloat(
+				src.data(), byteStride, ComponentFormatOf<Source>, normalized, components, count, actual.data());
+		} else {
+			ConvertComponentsToUint32(src.data(), byteStride, ComponentFormatOf<Source>, components, count, actual.data());
+		}
+		DoNotOptimize(actual.data());
+	});
+
+	const bool match = memcmp(expected.data(), actual.data(), expected.size() * sizeof(D)) == 0;
+	if (!match) { failed = true; }
+
+	const double values = static_cast<double>(count * components);
+	std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(3) << std::setw(10)
+	          << timeReference * 1e9 / values << std::setw(10) << timeKernel * 1e9 / values << std::setw(9)
+	          << std::setprecision(2) << timeReference / timeKernel << "x" << (match ? "" : "  MISMATCH") << std::endl;
+}
+
+int main(int argc, char** argv) {
+	const size_t count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+
+	std::cout << std::left << std::setw(32) << "Case" << std::right << std::setw(10) << "Ref ns" << std::setw(10)
+	          << "SIMD ns" << std::setw(10) << "Speedup" << std::endl;
+	RunCase<float, float>("float vec3 packed", 3, 12, false, count);
+	RunCase<float, float>("float vec4 packed", 4, 16, false, count);
+	RunCase<float, float>("float vec3 interleaved", 3, 32, false, count);
+	RunCase<uint8_t, float>("u8 vec4 normalized", 4, 4, true, count);
+	RunCase<int8_t, float>("i8 vec3 normalized (padded)", 3, 4, true, count);
+	RunCase<int8_t, float>("i8 vec4 normalized", 4, 4, true, count);
+	RunCase<uint16_t, float>("u16 vec2 normalized", 2, 4, true, count);
+	RunCase<uint16_t, float>("u16 vec3 (padded)", 3, 8, false, count);
+	RunCase<int16_t, float>("i16 vec3 normalized (padded)", 3, 8, true, count);
+	RunCase<int16_t, float>("i16 vec2 normalized", 2, 4, true, count);
+	RunCase<uint8_t, uint32_t>("u8 indices", 1, 1, false, count);
+	RunCase<uint16_t, uint32_t>("u16 indices", 1, 2, false, count);
+	RunCase<uint32_t, uint32_t>("u32 indices", 1, 4, false, count);
+	RunCase<uint8_t, uint32_t>("u8 joints", 4, 4, false, count);
+	RunCase<uint16_t, uint32_t>("u16 joints", 4, 8, false, count);
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,291 @@
+#include "AccessorKernels.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#	define KERNELS_X86 1
+#	include <immintrin.h>
+#	if defined(_MSC_VER) && !defined(__clang__)
+#		include <intrin.h>
+#		define KERNELS_AVX2
+#	else
+#		define KERNELS_AVX2 __attribute__((target("avx2")))
+#	endif
+#else
+#	define KERNELS_X86 0
+#endif
+
+/* ======================
+** === Scalar Kernels ===
+   ====================== */
+template <typename Source, bool Normalized>
+static float ToFloat(Source v) {
+	if constexpr (Normalized) {
+		constexpr float maxValue = static_cast<float>(std::numeric_limits<Source>::max());
+		if constexpr (std::is_signed_v<Source>) {
+			return std::max(static_cast<float>(v) / maxValue, -1.0f);
+		} else {
+			return static_cast<float>(v) / maxValue;
+		}
+	} else {
+		return static_cast<float>(v);
+	}
+}
+
+template <typename Source, typename Destination, bool Normalized>
+static void ConvertScalar(
+	const uint8_t* src, size_t byteStride, size_t components, size_t first, size_t count, Destination* dst) {
+	for (size_t i = first; i < count; ++i) {
+		const uint8_t* element = src + i * byteStride;
+		for (size_t c = 0; c < components; ++c) {
+			Source v;
+			memcpy(&v, element + c * sizeof(Source), sizeof(Source));
+			if constexpr (std::is_same_v<Destination, float>) {
+				dst[i * components + c] = ToFloat<Source, Normalized>(v);
+			} else {
+				dst[i * components + c] = static_cast<Destination>(v);
+			}
+		}
+	}
+}
+
+// Copy interleaved elements out of their buffer. The element size is a constant so that each copy is inlined.
+template <typename T, size_t Components>
+static void CopyElements(const uint8_t* src, size_t byteStride, size_t count, T* dst) {
+	for (size_t i = 0; i < count; ++i) { memcpy(dst + i * Components, src + i * byteStride, Components * sizeof(T)); }
+}
+
+/* ====================
+** === SIMD Kernels ===
+   ==================== */
+#if KERNELS_X86
+static bool HasAVX2() {
+	static const bool hasAVX2 = []() {
+#	if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 1);
+		const bool osSupport = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+		__cpuidex(info, 7, 0);
+		return osSupport && (info[1] & (1 << 5));
+#	else
+		return __builtin_cpu_supports("avx2") != 0;
+#	endif
+	}();
+
+	return hasAVX2;
+}
+
+// Load four components and widen them to 32-bit integers.
+template <typename Source>
+static __m128i Widen4(const uint8_t* src) {
+	if constexpr (sizeof(Source) == 1) {
+		int32_t packed;
+		memcpy(&packed, src, sizeof(packed));
+		const __m128i v = _mm_cvtsi32_si128(packed);
+		if constexpr (std::is_signed_v<Source>) {
+			return _mm_srai_epi32(_mm_unpacklo_epi16(_mm_unpacklo_epi8(v, v), _mm_unpacklo_epi8(v, v)), 24);
+		} else {
+			return _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, _mm_setzero_si128()), _mm_setzero_si128());
+		}
+	} else {
+		const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+		if constexpr (std::is_signed_v<Source>) {
+			return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		} else {
+			return _mm_unpacklo_epi16(v, _mm_setzero_si128());
+		}
+	}
+}
+
+template <typename Source, bool Normalized>
+static __m128 ToFloat4(__m128i v) {
+	__m128 f = _mm_cvtepi32_ps(v);
+	if constexpr (Normalized) {
+		f = _mm_div_ps(f, _mm_set1_ps(static_cast<float>(std::numeric_limits<Source>::max())));
+		if constexpr (std::is_signed_v<Source>) { f = _mm_max_ps(f, _mm_set1_ps(-1.0f)); }
+	}
+
+	return f;
+}
+
+// Load eight components and widen them to 32-bit integers.
+template <typename Source>
+KERNELS_AVX2 static __m256i Widen8(const uint8_t* src) {
+	if constexpr (sizeof(Source) == 1) {
+		const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+		if constexpr (std::is_signed_v<Source>) {
+			return _mm256_cvtepi8_epi32(v);
+		} else {
+			return _mm256_cvtepu8_epi32(v);
+		}
+	} else {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		if constexpr (std::is_signed_v<Source>) {
+			return _mm256_cvtepi16_epi32(v);
+		} else {
+			return _mm256_cvtepu16_epi32(v);
+		}
+	}
+}
+
+template <typename Source, bool Normalized>
+KERNELS_AVX2 static __m256 ToFloat8(__m256i v) {
+	__m256 f = _mm256_cvtepi32_ps(v);
+	if constexpr (Normalized) {
+		f = _mm256_div_ps(f, _mm256_set1_ps(static_cast<float>(std::numeric_limits<Source>::max())));
+		if constexpr (std::is_signed_v<Source>) { f = _mm256_max_ps(f, _mm256_set1_ps(-1.0f)); }
+	}
+
+	return f;
+}
+
+// Convert a tightly packed array of values, returning how many were converted. The remainder is left to scalar code.
+template <typename Source, typename Destination, bool Normalized>
+KERNELS_AVX2 static size_t ConvertPackedAVX2(const uint8_t* src, size_t valueCount, Destination* dst) {
+	size_t i = 0;
+	for (; i + 8 <= valueCount; i += 8) {
+		const __m256i v = Widen8<Source>(src + i * sizeof(Source));
+		if constexpr (std::is_same_v<Destination, float>) {
+			_mm256_storeu_ps(dst + i, ToFloat8<Source, Normalized>(v));
+		} else {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+		}
+	}
+
+	return i;
+}
+
+template <typename Source, typename Destination, bool Normalized>
+static size_t ConvertPackedSSE2(const uint8_t* src, size_t valueCount, Destination* dst) {
+	size_t i = 0;
+	for (; i + 4 <= valueCount; i += 4) {
+		const __m128i v = Widen4<Source>(src + i * sizeof(Source));
+		if constexpr (std::is_same_v<Destination, float>) {
+			_mm_storeu_ps(dst + i, ToFloat4<Source, Normalized>(v));
+		} else {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+		}
+	}
+
+	return i;
+}
+
+// Convert 3- or 4-component elements which are padded out to at least four components, such as quantized positions and
+// normals. Four components are always loaded and stored, and the extra output is overwritten by the next element, so
+// the final element is left to scalar code. Returns the number of elements converted.
+template <typename Source, typename Destination, bool Normalized>
+static size_t ConvertStridedSSE2(
+	const uint8_t* src, size_t byteStride, size_t components, size_t count, Destination* dst) {
+	if (count == 0 || byteStride < 4 * sizeof(Source) || (components != 3 && components != 4)) { return 0; }
+
+	for (size_t i = 0; i + 1 < count; ++i) {
+		const __m128i v = Widen4<Source>(src + i * byteStride);
+		if constexpr (std::is_same_v<Destination, float>) {
+			_mm_storeu_ps(dst + i * components, ToFloat4<Source, Normalized>(v));
+		} else {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * components), v);
+		}
+	}
+
+	return count - 1;
+}
+#endif
+
+/* ========================
+** === Kernel Selection ===
+   ======================== */
+template <typename Source, typename Destination, bool Normalized>
+static void Convert(const uint8_t* src, size_t byteStride, size_t components, size_t count, Destination* dst) {
+	const size_t elementSize = components * sizeof(Source);
+
+	// Data that is already in the destination format only needs to be copied.
+	if constexpr (sizeof(Source) == sizeof(Destination) && !Normalized &&
+	              std::is_floating_point_v<Source> == std::is_floating_point_v<Destination>) {
+		if (byteStride == elementSize) {
+			memcpy(dst, src, count * elementSize);
+		} else {
+			switch (components) {
+				case 1:
+					return CopyElements<Destination, 1>(src, byteStride, count, dst);
+				case 2:
+					return CopyElements<Destination, 2>(src, byteStride, count, dst);
+				case 3:
+					return CopyElements<Destination, 3>(src, byteStride, count, dst);
+				case 4:
+					return CopyElements<Destination, 4>(src, byteStride, count, dst);
+				default:
+					for (size_t i = 0; i < count; ++i) { memcpy(dst + i * components, src + i * byteStride, elementSize); }
+					break;
+			}
+		}
+		return;
+	}
+
+#if KERNELS_X86
+	if constexpr (std::is_integral_v<Source> && sizeof(Source) <= 2 &&
+	              (std::is_same_v<Destination, float> || std::is_unsigned_v<Source>)) {
+		if (byteStride == elementSize) {
+			// Tightly packed elements can be treated as one long array of components.
+			const size_t valueCount = count * components;
+			size_t done             = 0;
+			if (HasAVX2()) { done = ConvertPackedAVX2<Source, Destination, Normalized>(src, valueCount, dst); }
+			done += ConvertPackedSSE2<Source, Destination, Normalized>(
+				src + done * sizeof(Source), valueCount - done, dst + done);
+			ConvertScalar<Source, Destination, Normalized>(src, sizeof(Source), 1, done, valueCount, dst);
+			return;
+		}
+
+		const size_t done =
+			ConvertStridedSSE2<Source, Destination, Normalized>(src, byteStride, components, count, dst);
+		ConvertScalar<Source, Destination, Normalized>(src, byteStride, components, done, count, dst);
+		return;
+	}
+#endif
+
+	ConvertScalar<Source, Destination, Normalized>(src, byteStride, components, 0, count, dst);
+}
+
+template <typename Destination, bool Normalized>
+static void Convert(
+	const void* src, size_t byteStride, ComponentFormat format, size_t components, size_t count, Destination* dst) {
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(src);
+	switch (format) {
+		case ComponentFormat::Int8:
+			return Convert<int8_t, Destination, Normalized>(bytes, byteStride, components, count, dst);
+		case ComponentFormat::Uint8:
+			return Convert<uint8_t, Destination, Normalized>(bytes, byteStride, components, count, dst);
+		case ComponentFormat::Int16:
+			return Convert<int16_t, Destination, Normalized>(bytes, byteStride, components, count, dst);
+		case ComponentFormat::Uint16:
+			return Convert<uint16_t, Destination, Normalized>(bytes, byteStride, components, count, dst);
+		case ComponentFormat::Uint32:
+			return Convert<uint32_t, Destination, Normalized>(bytes, byteStride, components, count, dst);
+		case ComponentFormat::Float:
+			return Convert<float, Destination, Normalized>(bytes, byteStride, components, count, dst);
+		default:
+			throw std::runtime_error("Unknown component format given to accessor conversion!");
+	}
+}
+
+void ConvertComponentsToFloat(const void* src,
+                              size_t byteStride,
+                              ComponentFormat format,
+                              bool normalized,
+                              size_t components,
+                              size_t count,
+                              float* dst) {
+	if (normalized) {
+		Convert<float, true>(src, byteStride, format, components, count, dst);
+	} else {
+		Convert<float, false>(src, byteStride, format, components, count, dst);
+	}
+}
+
+void ConvertComponentsToUint32(
+	const void* src, size_t byteStride, ComponentFormat format, size_t components, size_t count, uint32_t* dst) {
+	Convert<uint32_t, false>(src, byteStride, format, components, count, dst);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Bulk conversion kernels for glTF accessor data. These cover the common accessor layouts (float data, normalized and
+// unnormalized 8/16-bit integers, and 8/16/32-bit indices) with SSE2, and AVX2 where the CPU supports it, falling back
+// to scalar code elsewhere. Every kernel produces exactly the same values as converting component by component.
+
+enum class ComponentFormat { Unknown, Int8, Uint8, Int16, Uint16, Uint32, Float };
+
+template <typename T>
+constexpr ComponentFormat ComponentFormatOf = ComponentFormat::Unknown;
+template <>
+constexpr ComponentFormat ComponentFormatOf<int8_t> = ComponentFormat::Int8;
+template <>
+constexpr ComponentFormat ComponentFormatOf<uint8_t> = ComponentFormat::Uint8;
+template <>
+constexpr ComponentFormat ComponentFormatOf<int16_t> = ComponentFormat::Int16;
+template <>
+constexpr ComponentFormat ComponentFormatOf<uint16_t> = ComponentFormat::Uint16;
+template <>
+constexpr ComponentFormat ComponentFormatOf<uint32_t> = ComponentFormat::Uint32;
+template <>
+constexpr ComponentFormat ComponentFormatOf<float> = ComponentFormat::Float;
+
+// Convert count elements of the given number of components, spaced byteStride bytes apart, into a tightly packed float
+// array. Normalized integers are mapped to [0, 1] or [-1, 1] as the glTF specification describes.
+void ConvertComponentsToFloat(const void* src,
+                              size_t byteStride,
+                              ComponentFormat format,
+                              bool normalized,
+                              size_t components,
+                              size_t count,
+                              float* dst);
+// Convert count elements of unsigned integer components, spaced byteStride bytes apart, into a tightly packed uint32
+// array. Used for indices and joint indices.
+void ConvertComponentsToUint32(
+	const void* src, size_t byteStride, ComponentFormat format, size_t components, size_t count, uint32_t* dst);
@@ -0,0 +1,355 @@
+// Microbenchmark for keyframe lookup. Every channel of a synthetic clip is sampled frame by frame, both with the linear
+// scan the viewer used to run over every key of every channel and with FindKeyframe, the sampled values are checked to
+// match, and the time per lookup of each is reported. Binary searching every lookup is reported as well, to show what
+// the cursor saves over searching alone.
+//
+// Cubic spline evaluation is measured too, blending the segments of every channel with BlendKeyframes against
+// evaluating the Hermite basis one component at a time.
+//
+// Finally, a clip shaped like motion capture (rotations and translations which move all the time, and scales which
+// never do) is compressed the way Model compresses animations. Its size is compared to storing every key as a float
+// time and a vec4, and the largest error of playing it back from the compressed keys is reported.
+//
+// Usage: AnimationBench [channels] [keys per channel]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "AnimationCompression.hpp"
+#include "Keyframes.hpp"
+
+struct Track {
+	std::vector<float> Times;
+	std::vector<float> Values;
+};
+
+// The original lookup, kept here as the baseline to compare against. Every interval is tested, and the last one which
+// contains the time wins.
+static float SampleScan(const Track& track, float time) {
+	float value = 0.0f;
+	for (size_t i = 0; i < track.Times.size() - 1; ++i) {
+		if ((time >= track.Times[i]) && (time <= track.Times[i + 1])) {
+			const float t = (time - track.Times[i]) / (track.Times[i + 1] - track.Times[i]);
+			value         = std::lerp(track.Values[i], track.Values[i + 1], t);
+		}
+	}
+
+	return value;
+}
+
+static float SampleBinarySearch(const Track& track, float time) {
+	const auto& times = track.Times;
+	if (time <= times.front()) { return track.Values.front(); }
+	if (time >= times.back()) { return track.Values.back(); }
+	const size_t i = (std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1;
+	const float t  = (time - times[i]) / (times[i + 1] - times[i]);
+
+	return std::lerp(track.Values[i], track.Values[i + 1], t);
+}
+
+static float SampleCursor(const Track& track, float time, KeyframeCursor& cursor) {
+	const auto key = FindKeyframe(track.Times, time, cursor);
+
+	return std::lerp(track.Values[key.Index], track.Values[key.Index + 1], key.Factor);
+}
+
+static volatile float benchSink = 0.0f;
+
+template <typename Func>
+static double TimeBest(Func&& func) {
+	double best = std::numeric_limits<double>::max();
+	for (int i = 0; i < 5; ++i) {
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		const auto end = std::chrono::high_resolution_clock::now();
+		best           = std::min(best, std::chrono::duration<double>(end - start).count());
+	}
+
+	return best;
+}
+
+static bool failed = false;
+
+// The Hermite spline evaluated one component at a time, kept here as the baseline for BlendKeyframes.
+static void ReferenceHermite(const float* segment, float t, float duration, float* dst) {
+	const float t2 = t * t;
+	const float t3 = t2 * t;
+	for (int c = 0; c < 4; ++c) {
+		const float v0 = segment[c];
+		const float b0 = segment[4 + c];
+		const float a1 = segment[8 + c];
+		const float v1 = segment[12 + c];
+		dst[c]         = (2.0f * t3 - 3.0f * t2 + 1.0f) * v0 + (t3 - 2.0f * t2 + t) * duration * b0 +
+		         (-2.0f * t3 + 3.0f * t2) * v1 + (t3 - t2) * duration * a1;
+	}
+}
+
+static void RunCubicCase(size_t channelCount, size_t keyCount, size_t frameCount) {
+	// Every channel's keys are laid out as glTF stores cubic splines, an in-tangent, value and out-tangent per key.
+	std::mt19937 rng(5678);
+	std::uniform_real_distribution<float> values(-10.0f, 10.0f);
+	std::vector<float> keys(channelCount * keyCount * 3 * 4);
+	for (auto& v : keys) { v = values(rng); }
+	std::uniform_real_distribution<float> factors(0.0f, 1.0f);
+	std::vector<const float*> frameSegments(channelCount * frameCount);
+	std::vector<float> frameFactors(channelCount * frameCount);
+	for (size_t i = 0; i < frameSegments.size(); ++i) {
+		// Frames move through the clip in order, as they do during playback.
+		const size_t channel = i % channelCount;
+		const size_t segment = (i / channelCount) * (keyCount - 1) / frameCount;
+		frameSegments[i]     = keys.data() + ((channel * keyCount + segment) * 3 + 1) * 4;
+		frameFactors[i]      = factors(rng);
+	}
+
+	std::vector<float> expected(frameSegments.size() * 4);
+	std::vector<float> actual(frameSegments.size() * 4);
+	const double timeReference = TimeBest([&]() {
+		for (size_t i = 0; i < frameSegments.size(); ++i) {
+			ReferenceHermite(frameSegments[i], frameFactors[i], 0.033f, expected.data() + i * 4);
+		}
+		benchSink = expected[0];
+	});
+
+	std::vector<KeyframeBlend> blends(channelCount);
+	const double timeBlend = TimeBest([&]() {
+		for (size_t f = 0; f < frameCount; ++f) {
+			for (size_t c = 0; c < channelCount; ++c) {
+				const size_t i = f * channelCount + c;
+				blends[c]      = HermiteBlend(frameSegments[i], frameFactors[i], 0.033f);
+			}
+			BlendKeyframes(blends, actual.data() + f * channelCount * 4);
+		}
+		benchSink = actual[0];
+	});
+
+	bool match = true;
+	for (size_t i = 0; i < expected.size(); ++i) {
+		if (std::abs(expected[i] - actual[i]) > 1e-4f * std::max(1.0f, std::abs(expected[i]))) { match = false; }
+	}
+	if (!match) { failed = true; }
+
+	const double evaluations = static_cast<double>(frameSegments.size());
+	std::cout << std::left << std::setw(28) << "Cubic spline evaluation" << std::right << std::fixed
+	          << std::setprecision(2) << std::setw(12) << timeReference * 1e9 / evaluations << std::setw(12)
+	          << timeBlend * 1e9 / evaluations << std::setw(11) << std::setprecision(1) << timeReference / timeBlend
+	          << "x"
+	          << (match ? "" : "  MISMATCH") << std::endl;
+}
+
+static void RunCase(const std::string& name, const std::vector<Track>& tracks, const std::vector<float>& frameTimes) {
+	const size_t lookups = tracks.size() * frameTimes.size();
+	std::vector<float> expected(lookups);
+	std::vector<float> actual(lookups);
+
+	// The scan costs as much per lookup as there are keys, so long clips only scan a subset of frames.
+	const size_t scanFrames = std::min<size_t>(frameTimes.size(), std::max<size_t>(4000000 / lookups, 1));
+
+	const double timeScan = TimeBest([&]() {
+		for (size_t f = 0; f < scanFrames; ++f) {
+			for (size_t c = 0; c < tracks.size(); ++c) {
+				expected[f * tracks.size() + c] = SampleScan(tracks[c], frameTimes[f]);
+			}
+		}
+		benchSink = expected[0];
+	});
+	const double timeSearch = TimeBest([&]() {
+		for (size_t f = 0; f < frameTimes.size(); ++f) {
+			for (size_t c = 0; c < tracks.size(); ++c) {
+				actual[f * tracks.size() + c] = SampleBinarySearch(tracks[c], frameTimes[f]);
+			}
+		}
+		benchSink = actual[0];
+	});
+
+	std::vector<KeyframeCursor> cursors(tracks.size());
+	const double timeCursor = TimeBest([&]() {
+		std::fill(cursors.begin(), cursors.end(), KeyframeCursor{});
+		for (size_t f = 0; f < frameTimes.size(); ++f) {
+			for (size_t c = 0; c < tracks.size(); ++c) {
+				actual[f * tracks.size() + c] = SampleCursor(tracks[c], frameTimes[f], cursors[c]);
+			}
+		}
+		benchSink = actual[0];
+	});
+
+	bool match = true;
+	for (size_t i = 0; i < scanFrames * tracks.size(); ++i) {
+		if (std::abs(expected[i] - actual[i]) > 1e-4f * std::max(1.0f, std::abs(expected[i]))) { match = false; }
+	}
+	if (!match) { failed = true; }
+
+	const double scanNs   = timeScan * 1e9 / (scanFrames * tracks.size());
+	const double searchNs = timeSearch * 1e9 / lookups;
+	const double cursorNs = timeCursor * 1e9 / lookups;
+	std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2) << std::setw(12)
+	          << scanNs << std::setw(12) << searchNs << std::setw(12) << cursorNs << std::setw(11) << std::setprecision(1)
+	          << scanNs / cursorNs << "x" << (match ? "" : "  MISMATCH") << std::endl;
+}
+
+// Sample a linearly interpolated track the way Animator does, reading its keys through getKey.
+template <typename GetKey>
+static glm::vec4 SampleLinear(
+	std::span<const float> times, float time, bool quaternion, KeyframeCursor& cursor, GetKey&& getKey) {
+	const auto key         = FindKeyframe(times, time, cursor);
+	const glm::vec4 keys[] = {getKey(key.Index), getKey(std::min(key.Index + 1, times.size() - 1))};
+	KeyframeBlend blend    = LerpBlend(&keys[0].x, &keys[1].x, key.Factor);
+	if (quaternion) { blend = SlerpBlend(&keys[0].x, &keys[1].x, key.Factor); }
+	glm::vec4 value;
+	BlendKeyframes(std::span(&blend, 1), &value.x);
+
+	return quaternion ? glm::normalize(value) : value;
+}
+
+static void RunCompressionCase(size_t channelCount, size_t keyCount) {
+	static constexpr float Tolerance = 1e-4f;  // The same tolerance Model uses for both rotations and vectors.
+
+	std::mt19937 rng(9012);
+	std::uniform_real_distribution<float> phases(0.0f, 6.28f);
+	std::normal_distribution<float> noise(0.0f, 1e-5f);
+	std::vector<float> times(keyCount);
+	for (size_t k = 0; k < keyCount; ++k) { times[k] = k / 30.0f; }
+
+	size_t rawBytes        = 0;
+	size_t compressedBytes = times.size() * sizeof(float);  // Tracks which keep every key share the original times.
+	size_t keysKept        = 0;
+	float rotationError    = 0.0f;
+	float vectorError      = 0.0f;
+	for (size_t c = 0; c < channelCount; ++c) {
+		const int kind    = static_cast<int>(c % 3);  // Rotation, translation, scale.
+		const float phase = phases(rng);
+		std::vector<glm::vec4> values(keyCount);
+		for (size_t k = 0; k < keyCount; ++k) {
+			const float t = times[k];
+			if (kind == 0) {
+				const float angle = 0.8f * std::sin(t * 1.3f + phase) + noise(rng);
+				const glm::vec3 axis(std::sin(phase), std::cos(phase), 0.3f);
+				const glm::vec3 n = axis / std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+				values[k]         = glm::vec4(n * std::sin(angle * 0.5f), std::cos(angle * 0.5f));
+			} else if (kind == 1) {
+				values[k] = glm::vec4(std::sin(t + phase), 0.1f * std::cos(t * 2.0f), 0.5f * t / times.back(), 0.0f) +
+				            glm::vec4(noise(rng), noise(rng), noise(rng), 0.0f);
+			} else {
+				values[k] = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+			}
+		}
+		rawBytes += keyCount * (sizeof(float) + sizeof(glm::vec4));
+
+		const bool quaternion = kind == 0;
+		float tolerance       = Tolerance;
+		if (!quaternion) {
+			glm::vec4 min = values[0];
+			glm::vec4 max = values[0];
+			for (const auto& value : values) {
+				min = glm::min(min, value);
+				max = glm::max(max, value);
+			}
+			const glm::vec4 extent = max - min;
+			tolerance              = Tolerance * std::max(std::max(extent.x, extent.y), std::max(extent.z, extent.w));
+		}
+		const auto kept = ReduceLinearKeys(times, values, quaternion, tolerance);
+		std::vector<float> keptTimes;
+		std::vector<glm::vec4> keptValues;
+		for (const uint32_t k : kept) {
+			keptTimes.push_back(times[k]);
+			keptValues.push_back(values[k]);
+		}
+		const auto keys = QuantizeKeys(keptValues, quaternion ? KeyEncoding::Quaternion : KeyEncoding::Vector3);
+		keysKept += kept.size();
+		compressedBytes += keys.GetByteSize() + (kept.size() < keyCount ? kept.size() * sizeof(float) : 0);
+
+		// Play both back at the keys' own times and halfway between them, where reduction errs the most.
+		KeyframeCursor rawCursor;
+		KeyframeCursor cursor;
+		for (size_t f = 0; f + 1 < keyCount * 2; ++f) {
+			const float time = (times[f / 2] + times[(f + 1) / 2]) * 0.5f;
+			const auto expected = SampleLinear(times, time, quaternion, rawCursor, [&](size_t i) { return values[i]; });
+			const auto actual =
+				SampleLinear(keptTimes, time, quaternion, cursor, [&](size_t i) { return keys.Decode(i); });
+
+			glm::vec4 d = glm::abs(expected - actual);
+			if (quaternion) { d = glm::min(d, glm::abs(expected + actual)); }
+			const float error = std::max(std::max(d.x, d.y), std::max(d.z, d.w));
+			if (quaternion) {
+				rotationError = std::max(rotationError, error);
+			} else {
+				vectorError = std::max(vectorError, error);
+			}
+		}
+	}
+
+	std::cout << "\nCompressed clip: " << keysKept << " of " << channelCount * keyCount << " keys kept, " << std::fixed
+	          << std::setprecision(2) << rawBytes / (1024.0 * 1024.0) << "MiB -> " << compressedBytes / (1024.0 * 1024.0)
+	          << "MiB (" << std::setprecision(1) << static_cast<double>(rawBytes) / compressedBytes << "x)\n";
+	std::cout << "  Largest error: " << std::scientific << std::setprecision(2) << rotationError
+	          << " (rotation components), " << vectorError << " (translation and scale)" << std::endl;
+	std::cout << std::fixed;
+
+	// Well past what quantizing and reducing at the tolerance above should ever cost.
+	if (rotationError > 1e-3f || vectorError > 1e-3f) { failed = true; }
+}
+
+int main(int argc, char** argv) {
+	const size_t channelCount = argc > 1 ? std::stoull(argv[1]) : 256;
+	const size_t keyCount     = argc > 2 ? std::max<size_t>(std::stoull(argv[2]), 2) : 2000;
+
+	// Keys are sampled at around 30Hz with some jitter, so that tracks do not all share the same times, and every track
+	// starts at 0 and ends at the same time as glTF clips usually do.
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> jitter(0.5f, 1.5f);
+	std::uniform_real_distribution<float> values(-10.0f, 10.0f);
+	std::vector<Track> tracks(channelCount);
+	float endTime = 0.0f;
+	for (auto& track : tracks) {
+		track.Times.resize(keyCount);
+		track.Values.resize(keyCount);
+		float time = 0.0f;
+		for (size_t k = 0; k < keyCount; ++k) {
+			track.Times[k]  = time;
+			track.Values[k] = values(rng);
+			time += jitter(rng) / 30.0f;
+		}
+		endTime = std::max(endTime, track.Times.back());
+	}
+	for (auto& track : tracks) {
+		const float scale = endTime / track.Times.back();
+		for (auto& time : track.Times) { time *= scale; }
+	}
+
+	// Play the clip through twice, so that lookups wrap around from the end back to the start as they do when looping.
+	auto Playback = [&](float speed) {
+		std::vector<float> frameTimes;
+		for (float time = 0.0f; time < endTime * 2.0f; time += speed / 60.0f) {
+			frameTimes.push_back(std::fmod(time, endTime));
+		}
+		return frameTimes;
+	};
+	std::vector<float> seekTimes(Playback(1.0f).size());
+	std::uniform_real_distribution<float> seeks(0.0f, endTime);
+	for (auto& time : seekTimes) { time = seeks(rng); }
+
+	std::cout << channelCount << " channels, " << keyCount << " keys per channel, " << std::setprecision(1) << std::fixed
+	          << endTime << "s clip\n";
+	std::cout << std::left << std::setw(28) << "Case" << std::right << std::setw(12) << "Scan ns" << std::setw(12)
+	          << "Search ns" << std::setw(12) << "Cursor ns" << std::setw(12) << "Speedup" << std::endl;
+	RunCase("Playback (60 FPS)", tracks, Playback(1.0f));
+	RunCase("Playback (60 FPS, 4x)", tracks, Playback(4.0f));
+	RunCase("Playback (60 FPS, 0.25x)", tracks, Playback(0.25f));
+	RunCase("Random seeks", tracks, seekTimes);
+
+	std::cout << "\n"
+	          << std::left << std::setw(28) << "Case" << std::right << std::setw(12) << "Scalar ns" << std::setw(12)
+	          << "Blend ns" << std::setw(12) << "Speedup" << std::endl;
+	RunCubicCase(channelCount, keyCount, 1000);
+
+	RunCompressionCase(channelCount, keyCount);
+
+	return failed ? 1 : 0;
+}
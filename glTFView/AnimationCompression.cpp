@@ -0,0 +1,173 @@
+#include "AnimationCompression.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Keyframes.hpp"
+
+// The smallest three components of a unit quaternion are never larger than this.
+static constexpr float QuaternionRange = 0.70710678f;
+// Each smallest component is stored in the low 15 bits of its value. The index of the largest component goes in the top
+// bits of the first two.
+static constexpr float QuaternionScale = 32767.0f;
+
+// How many keys in a row ReduceLinearKeys may drop. Checking a span costs as much as the keys in it, so this bounds the
+// reduction to linear time on long tracks which hardly move.
+static constexpr size_t MaxDroppedKeys = 64;
+
+static uint16_t QuantizeUnorm16(float value) {
+	return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+glm::vec4 QuantizedKeys::Decode(size_t index) const {
+	const uint16_t* key = Data.data() + index * GetStride();
+
+	if (Encoding == KeyEncoding::Quaternion) {
+		const uint32_t largest = ((key[0] >> 15) << 1) | (key[1] >> 15);
+		float smallest[3];
+		float sumSquares = 0.0f;
+		for (int c = 0; c < 3; ++c) {
+			smallest[c] = ((key[c] & 0x7fff) / QuaternionScale * 2.0f - 1.0f) * QuaternionRange;
+			sumSquares += smallest[c] * smallest[c];
+		}
+
+		glm::vec4 q;
+		for (uint32_t c = 0, s = 0; c < 4; ++c) {
+			q[c] = c == largest ? std::sqrt(std::max(1.0f - sumSquares, 0.0f)) : smallest[s++];
+		}
+
+		return q;
+	}
+
+	glm::vec4 v(0.0f);
+	for (size_t c = 0; c < GetStride(); ++c) { v[c] = Min[c] + Extent[c] * (key[c] / 65535.0f); }
+
+	return v;
+}
+
+QuantizedKeys QuantizeKeys(std::span<const glm::vec4> keys, KeyEncoding encoding) {
+	QuantizedKeys quantized;
+	quantized.Encoding = encoding;
+	const size_t stride = quantized.GetStride();
+	quantized.Data.resize(keys.size() * stride);
+
+	if (encoding == KeyEncoding::Quaternion) {
+		for (size_t i = 0; i < keys.size(); ++i) {
+			glm::vec4 q = keys[i];
+			const float length = glm::length(q);
+			if (length > 0.0f) { q /= length; }
+
+			uint32_t largest = 0;
+			for (uint32_t c = 1; c < 4; ++c) {
+				if (std::abs(q[c]) > std::abs(q[largest])) { largest = c; }
+			}
+			// q and -q are the same rotation, so make the largest component positive and leave it out.
+			if (q[largest] < 0.0f) { q = -q; }
+
+			uint16_t* key = quantized.Data.data() + i * stride;
+			for (uint32_t c = 0, s = 0; c < 4; ++c) {
+				if (c == largest) { continue; }
+				const float unorm = (std::clamp(q[c] / QuaternionRange, -1.0f, 1.0f) + 1.0f) * 0.5f;
+				key[s++]          = static_cast<uint16_t>(unorm * QuaternionScale + 0.5f);
+			}
+			key[0] |= static_cast<uint16_t>((largest >> 1) << 15);
+			key[1] |= static_cast<uint16_t>((largest & 1) << 15);
+		}
+
+		return quantized;
+	}
+
+	if (keys.empty()) { return quantized; }
+	glm::vec4 max = keys[0];
+	quantized.Min = keys[0];
+	for (const auto& key : keys) {
+		quantized.Min = glm::min(quantized.Min, key);
+		max           = glm::max(max, key);
+	}
+	quantized.Extent = max - quantized.Min;
+	if (stride == 3) {
+		quantized.Min.w    = 0.0f;
+		quantized.Extent.w = 0.0f;
+	}
+
+	for (size_t i = 0; i < keys.size(); ++i) {
+		uint16_t* key = quantized.Data.data() + i * stride;
+		for (size_t c = 0; c < stride; ++c) {
+			const float extent = quantized.Extent[c];
+			key[c]             = extent > 0.0f ? QuantizeUnorm16((keys[i][c] - quantized.Min[c]) / extent) : 0;
+		}
+	}
+
+	return quantized;
+}
+
+// How far apart two keys are, by their largest component difference. Quaternions are compared both ways around, as q
+// and -q are the same rotation.
+static float KeyError(const glm::vec4& a, const glm::vec4& b, bool quaternion) {
+	const glm::vec4 d = glm::abs(a - b);
+	float error       = std::max(std::max(d.x, d.y), std::max(d.z, d.w));
+	if (quaternion) {
+		const glm::vec4 n = glm::abs(a + b);
+		error             = std::min(error, std::max(std::max(n.x, n.y), std::max(n.z, n.w)));
+	}
+
+	return error;
+}
+
+std::vector<uint32_t> ReduceLinearKeys(std::span<const float> times,
+                                       std::span<const glm::vec4> values,
+                                       bool quaternion,
+                                       float tolerance) {
+	const size_t count = std::min(times.size(), values.size());
+	std::vector<uint32_t> kept;
+	if (count == 0) { return kept; }
+	kept.push_back(0);
+
+	bool constant = true;
+	for (size_t i = 1; i < count && constant; ++i) { constant = KeyError(values[i], values[0], quaternion) <= tolerance; }
+	if (constant) { return kept; }
+
+	// Grow a span from the last key kept for as long as interpolating across it reproduces every key inside it, then
+	// keep the key at its end and start again from there.
+	auto Interpolate = [&](size_t first, size_t last, float time) {
+		const float t = (time - times[first]) / (times[last] - times[first]);
+		KeyframeBlend blend;
+		if (quaternion) {
+			blend = SlerpBlend(&values[first].x, &values[last].x, t);
+		} else {
+			blend = LerpBlend(&values[first].x, &values[last].x, t);
+		}
+		glm::vec4 value;
+		BlendKeyframes(std::span(&blend, 1), &value.x);
+
+		return quaternion ? glm::normalize(value) : value;
+	};
+	auto SpanFits = [&](size_t first, size_t last) {
+		if (!(times[last] > times[first])) { return false; }
+		for (size_t i = first + 1; i < last; ++i) {
+			if (KeyError(Interpolate(first, last, times[i]), values[i], quaternion) > tolerance) { return false; }
+		}
+		return true;
+	};
+
+	size_t first = 0;
+	while (first + 1 < count) {
+		size_t last = first + 1;
+		while (last + 1 < count && last - first <= MaxDroppedKeys && SpanFits(first, last + 1)) { ++last; }
+		kept.push_back(static_cast<uint32_t>(last));
+		first = last;
+	}
+
+	return kept;
+}
+
+std::vector<uint32_t> ReduceStepKeys(std::span<const glm::vec4> values, float tolerance) {
+	std::vector<uint32_t> kept;
+	for (size_t i = 0; i < values.size(); ++i) {
+		if (kept.empty() || KeyError(values[i], values[kept.back()], false) > tolerance) {
+			kept.push_back(static_cast<uint32_t>(i));
+		}
+	}
+
+	return kept;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+// Compact storage for animation keyframes. Every vector is quantized to 16 bits a component, in one of three ways:
+//   - Vector3 and Vector4 map each component linearly from the smallest to the largest value it takes in the track.
+//   - Quaternion stores unit quaternions as their smallest three components, with the index of the largest one packed
+//     into their spare bits. The largest is rebuilt from the fact that the quaternion has unit length.
+// Before quantizing, keys which interpolation between their neighbours already reproduces can be dropped.
+
+enum class KeyEncoding : uint8_t { Vector3, Vector4, Quaternion };
+
+// A track of quantized keyframe vectors.
+struct QuantizedKeys {
+	// How many 16-bit values each key takes.
+	size_t GetStride() const {
+		return Encoding == KeyEncoding::Vector4 ? 4 : 3;
+	}
+	size_t Size() const {
+		return Data.size() / GetStride();
+	}
+	size_t GetByteSize() const {
+		return sizeof(QuantizedKeys) + Data.size() * sizeof(uint16_t);
+	}
+	// Decode a key. Vector3 tracks leave w as 0.
+	glm::vec4 Decode(size_t index) const;
+
+	KeyEncoding Encoding = KeyEncoding::Vector3;
+	glm::vec4 Min        = glm::vec4(0.0f);
+	glm::vec4 Extent     = glm::vec4(0.0f);  // Max - Min, for the Vector encodings.
+	std::vector<uint16_t> Data;
+};
+
+QuantizedKeys QuantizeKeys(std::span<const glm::vec4> keys, KeyEncoding encoding);
+
+// Find the keys of a linearly interpolated track which are needed to reproduce every key to within the given tolerance,
+// returning their indices. Quaternion tracks are compared the way they are played back, with slerp. Tracks which never
+// move are reduced to their first key, and otherwise the first and last keys are always kept.
+std::vector<uint32_t> ReduceLinearKeys(std::span<const float> times,
+                                       std::span<const glm::vec4> values,
+                                       bool quaternion,
+                                       float tolerance);
+// Find the keys of a stepped track which differ from the key before them by more than the given tolerance, returning
+// their indices. The first key is always kept.
+std::vector<uint32_t> ReduceStepKeys(std::span<const glm::vec4> values, float tolerance);
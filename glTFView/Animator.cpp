@@ -0,0 +1,111 @@
+#include "Animator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Model.hpp"
+#include "ThreadPool.hpp"
+
+// Channels are sampled in groups of this many per task. Animations with fewer channels are sampled on the thread
+// updating the animator, as splitting them would cost more than it saves.
+static constexpr size_t ChannelsPerTask = 256;
+
+Animator::Animator(Model& model) : _model(model) {}
+
+void Animator::Update(double time) {
+	Animator* animator = this;
+	Update(std::span(&animator, 1), time);
+}
+
+void Animator::Update(std::span<Animator* const> animators, double time) {
+	ThreadPool::Get().ParallelFor(animators.size(), [&](size_t i) {
+		// A model which is not animating draws its rest transforms, so there is no point sampling a pose for it.
+		auto* animator = animators[i];
+		if (animator->_model.Animate) {
+			animator->Evaluate(time);
+			animator->Apply();
+		}
+		animator->_model.UpdateTransforms();
+	});
+}
+
+void Animator::Evaluate(double time) {
+	const auto& animations     = _model.Animations;
+	const Animation* animation = nullptr;
+	if (_model.ActiveAnimation < animations.size()) { animation = animations[_model.ActiveAnimation].get(); }
+	if (animation != _animation) {
+		_animation                = animation;
+		const size_t channelCount = animation ? animation->Channels.size() : 0;
+		_cursors.assign(channelCount, {});
+		_blends.resize(channelCount);
+		_keys.resize(channelCount * 4);
+		_pose.assign(channelCount, glm::vec4(0.0f));
+	}
+	if (!_animation) { return; }
+
+	// Loop over the span of the animation's keys, which need not start at zero.
+	const double duration     = _animation->EndTime - _animation->StartTime;
+	const float loopTime      = duration > 0.0 ? static_cast<float>(std::fmod(time, duration)) : 0.0f;
+	const float animationTime = _animation->StartTime + loopTime;
+	const size_t channelCount = _animation->Channels.size();
+	const size_t taskCount    = (channelCount + ChannelsPerTask - 1) / ChannelsPerTask;
+	if (taskCount <= 1) {
+		EvaluateChannels(animationTime, 0, channelCount);
+		return;
+	}
+
+	ThreadPool::Get().ParallelFor(taskCount, [&](size_t task) {
+		const size_t first = task * ChannelsPerTask;
+		EvaluateChannels(animationTime, first, std::min(first + ChannelsPerTask, channelCount));
+	});
+}
+
+void Animator::EvaluateChannels(float time, size_t first, size_t last) {
+	static constexpr float Zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+	// Work out what to blend for every channel first, so that the values can all be blended in one pass.
+	for (size_t i = first; i < last; ++i) {
+		const auto& channel = _animation->Channels[i];
+		if (!_animation->IsPlayable(channel)) {
+			_blends[i] = StepBlend(Zero);
+			continue;
+		}
+
+		_blends[i] = _animation->GetBlend(channel, time, _cursors[i], &_keys[i * 4]);
+	}
+	BlendKeyframes(std::span(_blends).subspan(first, last - first), glm::value_ptr(_pose[first]));
+
+	for (size_t i = first; i < last; ++i) {
+		const auto& channel = _animation->Channels[i];
+		if (channel.Path == AnimationPath::Rotation && _animation->IsPlayable(channel)) {
+			_pose[i] = glm::normalize(_pose[i]);
+		}
+	}
+}
+
+void Animator::Apply() {
+	if (!_animation) { return; }
+
+	for (size_t i = 0; i < _pose.size(); ++i) {
+		const auto& channel = _animation->Channels[i];
+		if (!_animation->IsPlayable(channel)) { continue; }
+
+		const auto& value = _pose[i];
+		switch (channel.Path) {
+			case AnimationPath::Translation:
+				channel.Target->SetAnimTranslation(value);
+				break;
+
+			case AnimationPath::Rotation:
+				channel.Target->SetAnimRotation(glm::quat(value.w, value.x, value.y, value.z));
+				break;
+
+			case AnimationPath::Scale:
+				channel.Target->SetAnimScale(value);
+				break;
+
+			default:
+				break;
+		}
+	}
+}
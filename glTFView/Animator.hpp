@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+#include "Keyframes.hpp"
+
+class Model;
+struct Animation;
+
+// Plays a model's active animation. Each frame, every channel of the animation is sampled into a pose buffer, which is
+// then written into the animated transforms of the nodes the channels target. The animation data itself is only read,
+// and everything which changes as it plays (the keyframe cursors, decoded keys and the pose) lives here, so any number
+// of animators can be updated at once.
+class Animator {
+ public:
+	explicit Animator(Model& model);
+
+	// Sample the active animation at the given time, apply it to the model's nodes, and bring the model's transforms up
+	// to date. Animations loop over the span of their keys, so any time can be given. Models which are not animating
+	// only have their transforms updated.
+	void Update(double time);
+	// Update several animators at once, spreading the models, and the channels of large animations, across the thread
+	// pool. Every animator must belong to a different model.
+	static void Update(std::span<Animator* const> animators, double time);
+
+	Model& GetModel() const {
+		return _model;
+	}
+	// The sampled value of every channel of the active animation, in the order of its channels. Rotations are
+	// normalized quaternions stored as (x, y, z, w), and translations and scales leave w unused.
+	std::span<const glm::vec4> GetPose() const {
+		return _pose;
+	}
+
+ private:
+	// Sample every channel into the pose buffer, without touching the model's nodes.
+	void Evaluate(double time);
+	// Write the pose buffer into the animated transforms of the model's nodes.
+	void Apply();
+	// Sample channels [first, last) into the pose buffer.
+	void EvaluateChannels(float time, size_t first, size_t last);
+
+	Model& _model;
+	const Animation* _animation = nullptr;
+	std::vector<KeyframeCursor> _cursors;  // One per channel, so that channels sharing a sampler can run on any thread.
+	std::vector<KeyframeBlend> _blends;
+	std::vector<glm::vec4> _keys;  // The keys each channel's blend decoded, four per channel.
+	std::vector<glm::vec4> _pose;
+};
@@ -2,6 +2,18 @@
 
 #include <fstream>
 #include <sstream>
+#include <utility>
+
+#ifdef _WIN32
+#	define NOMINMAX
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
 
 std::string ReadFile(const std::filesystem::path& filePath) {
 	std::ifstream file(filePath);
@@ -24,3 +36,91 @@ std::vector<uint8_t> ReadFileBinary(const std::filesystem::path& filePath) {
 
 	return bytes;
 }
+
+MappedFile::MappedFile(const std::filesystem::path& filePath) {
+#ifdef _WIN32
+	HANDLE file = CreateFileW(filePath.c_str(),
+	                          GENERIC_READ,
+	                          FILE_SHARE_READ,
+	                          nullptr,
+	                          OPEN_EXISTING,
+	                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+	                          nullptr);
+	if (file == INVALID_HANDLE_VALUE) { throw std::runtime_error("Failed to open file for reading!"); }
+	_file = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		Close();
+		throw std::runtime_error("Failed to query file size!");
+	}
+	_size = static_cast<size_t>(fileSize.QuadPart);
+	if (_size == 0) { return; }
+
+	_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping == nullptr) {
+		Close();
+		throw std::runtime_error("Failed to map file!");
+	}
+	_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+	_file = open(filePath.c_str(), O_RDONLY);
+	if (_file < 0) { throw std::runtime_error("Failed to open file for reading!"); }
+
+	struct stat fileStat;
+	if (fstat(_file, &fileStat) != 0) {
+		Close();
+		throw std::runtime_error("Failed to query file size!");
+	}
+	_size = static_cast<size_t>(fileStat.st_size);
+	if (_size == 0) { return; }
+
+	void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+	if (data != MAP_FAILED) {
+		_data = reinterpret_cast<const uint8_t*>(data);
+		madvise(data, _size, MADV_WILLNEED);
+	}
+#endif
+	if (_data == nullptr) {
+		Close();
+		throw std::runtime_error("Failed to map file!");
+	}
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		Close();
+		std::swap(_data, other._data);
+		std::swap(_size, other._size);
+		std::swap(_file, other._file);
+#ifdef _WIN32
+		std::swap(_mapping, other._mapping);
+#endif
+	}
+
+	return *this;
+}
+
+MappedFile::~MappedFile() noexcept {
+	Close();
+}
+
+void MappedFile::Close() noexcept {
+#ifdef _WIN32
+	if (_data) { UnmapViewOfFile(_data); }
+	if (_mapping) { CloseHandle(_mapping); }
+	if (_file) { CloseHandle(_file); }
+	_mapping = nullptr;
+	_file    = nullptr;
+#else
+	if (_data) { munmap(const_cast<uint8_t*>(_data), _size); }
+	if (_file >= 0) { close(_file); }
+	_file = -1;
+#endif
+	_data = nullptr;
+	_size = 0;
+}
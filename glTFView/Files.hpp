@@ -1,8 +1,50 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <span>
 #include <string>
 #include <vector>
 
 std::string ReadFile(const std::filesystem::path& filePath);
 std::vector<uint8_t> ReadFileBinary(const std::filesystem::path& filePath);
+
+// Whether count elements starting at first lie within size, without overflowing on values read from a corrupt file.
+inline bool RangeFits(uint64_t first, uint64_t count, uint64_t size) {
+	return first <= size && count <= size - first;
+}
+
+// A read-only view of an entire file, mapped into memory. Pages are only read from disk as they are touched, and the
+// data is never copied into a separate allocation.
+class MappedFile {
+ public:
+	MappedFile() = default;
+	explicit MappedFile(const std::filesystem::path& filePath);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	~MappedFile() noexcept;
+
+	std::span<const uint8_t> Bytes() const {
+		return {_data, _size};
+	}
+	const uint8_t* Data() const {
+		return _data;
+	}
+	size_t Size() const {
+		return _size;
+	}
+
+ private:
+	void Close() noexcept;
+
+	const uint8_t* _data = nullptr;
+	size_t _size         = 0;
+#ifdef _WIN32
+	void* _file    = nullptr;
+	void* _mapping = nullptr;
+#else
+	int _file = -1;
+#endif
+};
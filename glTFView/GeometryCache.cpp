@@ -0,0 +1,163 @@
+#include "GeometryCache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Meshlets.hpp"
+#include "ThreadPool.hpp"
+#include "VertexPacking.hpp"
+
+static constexpr size_t DataAlignment = 16;
+static constexpr size_t HashChunkSize = 4 * 1024 * 1024;
+
+static size_t AlignUp(size_t value, size_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+tk::Hash GeometryCache::HashContents(const void* data, size_t size) {
+	const uint8_t* bytes    = reinterpret_cast<const uint8_t*>(data);
+	const size_t chunkCount = (size + HashChunkSize - 1) / HashChunkSize;
+
+	// Hash each chunk independently, then hash the chunk hashes together.
+	std::vector<tk::Hash> chunkHashes(chunkCount);
+	ThreadPool::Get().ParallelFor(chunkCount, [&](size_t i) {
+		const size_t offset = i * HashChunkSize;
+		tk::Hasher h;
+		h.Data(std::min(HashChunkSize, size - offset), bytes + offset);
+		chunkHashes[i] = h.Get();
+	});
+
+	tk::Hasher h;
+	h(size);
+	for (const auto chunkHash : chunkHashes) { h(chunkHash); }
+
+	return h.Get();
+}
+
+std::filesystem::path GeometryCache::GetCachePath(tk::Hash key) {
+	std::stringstream name;
+	name << std::hex << key << ".geo";
+
+	return std::filesystem::path("Cache") / "Geometry" / name.str();
+}
+
+void GeometryCache::AddMesh(MeshRecord mesh,
+                            const std::vector<SubmeshRecord>& submeshes,
+                            const void* data,
+                            size_t dataSize) {
+	mesh.FirstSubmesh = _submeshRecords.size();
+	mesh.SubmeshCount = submeshes.size();
+	mesh.DataOffset   = AlignUp(_meshData.size(), DataAlignment);
+	mesh.DataSize     = dataSize;
+
+	_meshRecords.push_back(mesh);
+	_submeshRecords.insert(_submeshRecords.end(), submeshes.begin(), submeshes.end());
+	_meshData.resize(mesh.DataOffset + dataSize);
+	memcpy(_meshData.data() + mesh.DataOffset, data, dataSize);
+
+	UpdateViews();
+}
+
+bool GeometryCache::Load(const std::filesystem::path& cachePath, tk::Hash key, size_t materialCount) {
+	if (!std::filesystem::exists(cachePath)) { return false; }
+
+	try {
+		_file = MappedFile(cachePath);
+	} catch (const std::exception& e) { return false; }
+
+	// Validate everything we can before trusting any of the offsets in the file.
+	Header header;
+	if (_file.Size() < sizeof(header)) { return false; }
+	memcpy(&header, _file.Data(), sizeof(header));
+	if (header.Magic != FileMagic || header.Version != FileVersion || header.Key != key) { return false; }
+
+	// Every count is bounded by the size of the file before it is multiplied, and every range is checked by subtraction,
+	// so that no value read from a corrupt file can overflow.
+	if (header.MeshCount > _file.Size() / sizeof(MeshRecord) ||
+	    header.SubmeshCount > _file.Size() / sizeof(SubmeshRecord)) {
+		return false;
+	}
+	const size_t meshOffset    = sizeof(Header);
+	const size_t submeshOffset = meshOffset + header.MeshCount * sizeof(MeshRecord);
+	const size_t tablesEnd     = submeshOffset + header.SubmeshCount * sizeof(SubmeshRecord);
+	if (tablesEnd > header.DataOffset || header.DataOffset % DataAlignment != 0 ||
+	    !RangeFits(header.DataOffset, header.DataSize, _file.Size())) {
+		return false;
+	}
+
+	_meshes    = {reinterpret_cast<const MeshRecord*>(_file.Data() + meshOffset), header.MeshCount};
+	_submeshes = {reinterpret_cast<const SubmeshRecord*>(_file.Data() + submeshOffset), header.SubmeshCount};
+	_data      = {_file.Data() + header.DataOffset, header.DataSize};
+
+	// Every range a mesh or submesh refers to must lie within the data it was stored with, so that nothing drawn from
+	// the cache can read past its buffers. The index size is checked before anything is divided by it, and each count
+	// is bounded by the mesh's data size over its element size, so that multiplying the two cannot overflow.
+	for (const auto& mesh : _meshes) {
+		bool valid = RangeFits(mesh.FirstSubmesh, mesh.SubmeshCount, header.SubmeshCount) &&
+		             RangeFits(mesh.DataOffset, mesh.DataSize, header.DataSize) &&
+		             (mesh.IndexSize == sizeof(uint16_t) || mesh.IndexSize == sizeof(uint32_t)) &&
+		             mesh.TotalIndexCount <= mesh.DataSize / mesh.IndexSize &&
+		             mesh.MeshletCount <= mesh.DataSize / sizeof(Meshlet);
+		if (valid) {
+			const auto format      = GetPackedVertexFormat(PackedVertexLayout(mesh.VertexLayout), mesh.TotalVertexCount);
+			const bool meshletsFit =
+				mesh.MeshletCount == 0 || RangeFits(mesh.MeshletOffset, mesh.MeshletCount * sizeof(Meshlet), mesh.DataSize);
+			valid                  = mesh.TotalVertexCount <= mesh.IndexOffset / format.VertexSize && meshletsFit &&
+			                         RangeFits(mesh.IndexOffset, mesh.TotalIndexCount * mesh.IndexSize, mesh.DataSize);
+		}
+		for (size_t i = 0; valid && i < mesh.SubmeshCount; ++i) {
+			const auto& submesh = _submeshes[mesh.FirstSubmesh + i];
+			valid               = submesh.Material < materialCount && submesh.LodCount <= MaxLods &&
+			                      RangeFits(submesh.FirstVertex, submesh.VertexCount, mesh.TotalVertexCount) &&
+			                      RangeFits(submesh.FirstIndex, submesh.IndexCount, mesh.TotalIndexCount) &&
+			                      RangeFits(submesh.FirstMeshlet, submesh.MeshletCount, mesh.MeshletCount);
+			for (uint32_t j = 0; valid && j < submesh.LodCount; ++j) {
+				valid = RangeFits(submesh.Lods[j].FirstIndex, submesh.Lods[j].IndexCount, mesh.TotalIndexCount);
+			}
+		}
+		if (!valid) {
+			_meshes    = {};
+			_submeshes = {};
+			_data      = {};
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void GeometryCache::Save(const std::filesystem::path& cachePath, tk::Hash key) const {
+	Header header{.Key          = key,
+	              .MeshCount    = _meshes.size(),
+	              .SubmeshCount = _submeshes.size(),
+	              .DataSize     = _data.size()};
+	const size_t tablesEnd = sizeof(Header) + _meshes.size_bytes() + _submeshes.size_bytes();
+	header.DataOffset      = AlignUp(tablesEnd, DataAlignment);
+
+	std::filesystem::create_directories(cachePath.parent_path());
+
+	// Write to a temporary file first, so that an interrupted write never leaves a truncated cache behind.
+	auto tempPath = cachePath;
+	tempPath += ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) { throw std::runtime_error("Failed to open file for writing!"); }
+
+		const char padding[DataAlignment] = {};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(_meshes.data()), _meshes.size_bytes());
+		file.write(reinterpret_cast<const char*>(_submeshes.data()), _submeshes.size_bytes());
+		file.write(padding, header.DataOffset - tablesEnd);
+		file.write(reinterpret_cast<const char*>(_data.data()), _data.size());
+		if (!file.good()) { throw std::runtime_error("Failed to write geometry cache!"); }
+	}
+	std::filesystem::rename(tempPath, cachePath);
+}
+
+void GeometryCache::UpdateViews() {
+	_meshes    = _meshRecords;
+	_submeshes = _submeshRecords;
+	_data      = _meshData;
+}
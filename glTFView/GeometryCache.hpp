@@ -0,0 +1,113 @@
+#pragma once
+
+#include <Tsuki/Hash.hpp>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+#include "Files.hpp"
+
+// An on-disk cache of fully processed mesh geometry, so that models which have not changed can skip the entire mesh
+// processing chain. A cache file is laid out to be usable as-is once in memory: a header, followed by a table of mesh
+// records, a table of submesh records, and finally the raw GPU buffer contents for every mesh. A mesh's buffer holds its
+// vertices, then its indices, then its meshlets. The indices of each submesh's levels of detail come after those of
+// all of the full submeshes.
+class GeometryCache {
+ public:
+	static constexpr uint32_t FileMagic   = 0x4f454754;  // "TGEO"
+	static constexpr uint32_t FileVersion = 6;
+	// The most simplified levels of detail a submesh can have, not counting the full submesh itself.
+	static constexpr uint32_t MaxLods = 4;
+
+	struct Header {
+		uint32_t Magic        = FileMagic;
+		uint32_t Version      = FileVersion;
+		tk::Hash Key          = 0;
+		uint64_t MeshCount    = 0;
+		uint64_t SubmeshCount = 0;
+		uint64_t DataOffset   = 0;
+		uint64_t DataSize     = 0;
+	};
+
+	struct LodRecord {
+		uint64_t FirstIndex = 0;
+		uint64_t IndexCount = 0;
+		float Error         = 0.0f;  // Relative to the size of the submesh's bounds.
+		uint32_t Padding    = 0;
+	};
+
+	struct SubmeshRecord {
+		uint64_t VertexCount  = 0;
+		uint64_t IndexCount   = 0;
+		uint64_t FirstVertex  = 0;
+		uint64_t FirstIndex   = 0;
+		glm::vec3 BoundsMin   = glm::vec3(0.0f);
+		glm::vec3 BoundsMax   = glm::vec3(0.0f);
+		uint32_t Material     = 0;
+		uint32_t BoundsValid  = 0;
+		uint32_t FirstMeshlet = 0;
+		uint32_t MeshletCount = 0;
+		uint32_t LodCount     = 0;
+		uint32_t Padding      = 0;
+		LodRecord Lods[MaxLods];
+	};
+
+	struct MeshRecord {
+		uint64_t FirstSubmesh     = 0;
+		uint64_t SubmeshCount     = 0;
+		uint64_t DataOffset       = 0;
+		uint64_t DataSize         = 0;
+		uint64_t IndexOffset      = 0;
+		uint64_t TotalVertexCount = 0;
+		uint64_t TotalIndexCount  = 0;
+		uint64_t MeshletOffset    = 0;
+		uint64_t MeshletCount     = 0;
+		glm::vec3 BoundsMin       = glm::vec3(0.0f);
+		glm::vec3 BoundsMax       = glm::vec3(0.0f);
+		uint32_t BoundsValid      = 0;
+		uint32_t VertexLayout     = 0;  // A PackedVertexLayout.
+		uint32_t IndexSize        = 0;  // 2 or 4 bytes.
+		uint32_t Padding          = 0;
+	};
+
+	GeometryCache()                                = default;
+	GeometryCache(const GeometryCache&)            = delete;
+	GeometryCache(GeometryCache&&)                 = default;
+	GeometryCache& operator=(const GeometryCache&) = delete;
+	GeometryCache& operator=(GeometryCache&&)      = default;
+
+	// Hash a block of memory, splitting large blocks across the thread pool.
+	static tk::Hash HashContents(const void* data, size_t size);
+	static std::filesystem::path GetCachePath(tk::Hash key);
+
+	// Append a mesh to a cache being built in memory. The mesh's submesh and data offsets are filled in automatically.
+	void AddMesh(MeshRecord mesh, const std::vector<SubmeshRecord>& submeshes, const void* data, size_t dataSize);
+	// Load a cache file, returning false if it does not exist, does not match the given key, or any of its records refer
+	// to data outside the file or to a material index of materialCount or above. The file is mapped into memory and
+	// stays mapped for the lifetime of the cache, so mesh data can be uploaded straight from the page cache.
+	bool Load(const std::filesystem::path& cachePath, tk::Hash key, size_t materialCount);
+	void Save(const std::filesystem::path& cachePath, tk::Hash key) const;
+
+	std::span<const MeshRecord> GetMeshes() const {
+		return _meshes;
+	}
+	std::span<const SubmeshRecord> GetSubmeshes(const MeshRecord& mesh) const {
+		return _submeshes.subspan(mesh.FirstSubmesh, mesh.SubmeshCount);
+	}
+	const uint8_t* GetMeshData(const MeshRecord& mesh) const {
+		return _data.data() + mesh.DataOffset;
+	}
+
+ private:
+	void UpdateViews();
+
+	std::vector<MeshRecord> _meshRecords;
+	std::vector<SubmeshRecord> _submeshRecords;
+	std::vector<uint8_t> _meshData;
+	MappedFile _file;
+
+	std::span<const MeshRecord> _meshes;
+	std::span<const SubmeshRecord> _submeshes;
+	std::span<const uint8_t> _data;
+};
@@ -0,0 +1,40 @@
+#include "ImageCache.hpp"
+
+#include <algorithm>
+
+// The map is never pruned below this many entries, as scanning a small map saves next to nothing.
+static constexpr size_t MinPruneSize = 64;
+
+ImageCache& ImageCache::Get(const tk::Device* device) {
+	static std::mutex mutex;
+	static std::unordered_map<const tk::Device*, std::unique_ptr<ImageCache>> caches;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto& cache = caches[device];
+	if (!cache) { cache = std::make_unique<ImageCache>(); }
+
+	return *cache;
+}
+
+std::shared_ptr<Image> ImageCache::Find(tk::Hash key) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _images.find(key);
+	if (it == _images.end()) { return nullptr; }
+
+	auto image = it->second.lock();
+	if (!image) { _images.erase(it); }
+
+	return image;
+}
+
+void ImageCache::Add(tk::Hash key, const std::shared_ptr<Image>& image) {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// Forget any images which have since been freed, so that the map only grows with the number of live images. Only
+	// doing so once the map has doubled since the last time keeps the cost of adding an image constant on average.
+	if (_images.size() >= _pruneSize) {
+		std::erase_if(_images, [](const auto& entry) { return entry.second.expired(); });
+		_pruneSize = std::max(_images.size() * 2, MinPruneSize);
+	}
+	_images[key] = image;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Tsuki/Common.hpp>
+#include <Tsuki/Hash.hpp>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+struct Image;
+
+// A device-wide registry of the images every loaded model is using, so that identical textures are only uploaded once,
+// whether they are referenced by several images in one model or by several models. Images are keyed by the hash of
+// their source bytes along with everything which decides their format.
+//
+// The cache only holds weak references. An image is freed as soon as the last model using it is, and a later model
+// with the same texture uploads it again. Entries for freed images are dropped when they are next looked up, or
+// whenever the map has doubled in size since it was last pruned.
+class ImageCache {
+ public:
+	// The cache of images created on the given device. Models imported without a device share one of their own.
+	static ImageCache& Get(const tk::Device* device);
+
+	// Find a live image created with the given key, or nullptr if there is none.
+	std::shared_ptr<Image> Find(tk::Hash key);
+	// Register a newly created image, so that later lookups of its key share it.
+	void Add(tk::Hash key, const std::shared_ptr<Image>& image);
+
+ private:
+	std::mutex _mutex;
+	std::unordered_map<tk::Hash, std::weak_ptr<Image>> _images;
+	size_t _pruneSize = 0;
+};
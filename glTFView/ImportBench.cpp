@@ -0,0 +1,264 @@
+// Headless benchmark for model import. Every model is loaded through Model several times on a device created without a
+// window or swapchain, and the minimum, median and 95th percentile time of each stage of its load profile is reported,
+// along with the peak memory use of the whole run. Any Vulkan driver will do, including software ones such as lavapipe,
+// and with --no-upload no device is created at all, so the benchmark runs without a Vulkan driver.
+//
+// Usage: ImportBench [--iterations N] [--depth N] [--no-upload] [--cold] [--json path] model.gltf...
+//   --iterations N  Load each model N times (default 10).
+//   --depth N       Report stages up to N levels below the total (default 2).
+//   --no-upload     Import without a device, so that nothing is created or uploaded.
+//   --cold          Clear the geometry and texture caches before every load, so that nothing is reused from disk.
+//   --json path     Also write the results to a JSON file.
+
+#include <Tsuki/CommandBuffer.hpp>
+#include <Tsuki/Context.hpp>
+#include <Tsuki/Device.hpp>
+#include <Tsuki/Fence.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GeometryCache.hpp"
+#include "LoadProfile.hpp"
+#include "Model.hpp"
+#include "TextureCache.hpp"
+
+#ifdef _WIN32
+#	define NOMINMAX
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+#	include <psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
+// The timings of one stage across every iteration of one model. Stages are identified by their path through the
+// profile, as several parents can have children of the same name.
+struct StageSamples {
+	std::string Path;
+	std::string Name;
+	int Depth = 0;
+	std::vector<double> Times;
+	uint64_t Bytes = 0;
+
+	double Percentile(double p) const {
+		std::vector<double> sorted = Times;
+		std::sort(sorted.begin(), sorted.end());
+		const size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+
+		return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+	}
+};
+
+struct ModelResults {
+	std::filesystem::path Path;
+	std::vector<StageSamples> Stages;
+	std::unordered_map<std::string, size_t> StageIndices;
+	size_t Failures = 0;
+
+	void AddSample(const std::string& path, const std::string& name, int depth, double time, uint64_t bytes) {
+		auto [it, inserted] = StageIndices.try_emplace(path, Stages.size());
+		if (inserted) { Stages.push_back({.Path = path, .Name = name, .Depth = depth}); }
+		auto& stage = Stages[it->second];
+		stage.Times.push_back(time);
+		stage.Bytes = bytes;
+	}
+
+	void AddStage(const LoadProfileStage& stage, const std::string& parentPath, int depth, int maxDepth) {
+		const std::string path = parentPath.empty() ? stage.Name : parentPath + "/" + stage.Name;
+		AddSample(path, stage.Name, depth, stage.Time, stage.Bytes);
+		if (depth >= maxDepth) { return; }
+		for (const auto& child : stage.Children) { AddStage(child, path, depth + 1, maxDepth); }
+	}
+};
+
+// The most memory the process has had resident at once since it started. This only ever grows, so it describes the
+// whole run rather than any one model.
+static uint64_t GetPeakMemoryUsage() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) { return 0; }
+
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage = {};
+	if (getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+#	ifdef __APPLE__
+	return static_cast<uint64_t>(usage.ru_maxrss);
+#	else
+	return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#	endif
+#endif
+}
+
+static void PrintResults(const ModelResults& results, size_t iterations) {
+	std::cout << "\n" << results.Path.string() << "\n";
+	if (results.Failures > 0) { std::cout << "  " << results.Failures << " of " << iterations << " loads failed\n"; }
+	std::cout << std::fixed << "  " << std::left << std::setw(44) << "Stage" << std::right << std::setw(11) << "Min ms"
+	          << std::setw(11) << "Median ms" << std::setw(11) << "P95 ms" << std::setw(11) << "MiB" << std::setw(11)
+	          << "MiB/s" << "\n";
+	for (const auto& stage : results.Stages) {
+		std::string name = std::string(stage.Depth * 2, ' ') + stage.Name;
+		if (stage.Times.size() < iterations) {
+			name += " (" + std::to_string(stage.Times.size()) + "/" + std::to_string(iterations) + ")";
+		}
+
+		const double median = stage.Percentile(0.5);
+		std::cout << "  " << std::left << std::setw(44) << name << std::right << std::setprecision(3) << std::setw(11)
+		          << stage.Percentile(0.0) * 1000.0 << std::setw(11) << median * 1000.0 << std::setw(11)
+		          << stage.Percentile(0.95) * 1000.0;
+		if (stage.Bytes > 0) {
+			const double mib = stage.Bytes / (1024.0 * 1024.0);
+			std::cout << std::setprecision(2) << std::setw(11) << mib;
+			if (median > 0.0) { std::cout << std::setprecision(1) << std::setw(11) << mib / median; }
+		}
+		std::cout << "\n";
+	}
+	std::cout.flush();
+}
+
+static void SaveResults(const std::filesystem::path& jsonPath,
+                        const std::vector<ModelResults>& models,
+                        size_t iterations,
+                        const ModelLoadOptions& options,
+                        uint64_t peakMemory) {
+	std::ofstream file(jsonPath, std::ios::trunc);
+	if (!file.is_open()) { throw std::runtime_error("Failed to open file for writing!"); }
+
+	file.precision(9);
+	file << "{\n  \"iterations\": " << iterations << ",\n  \"uploadData\": " << (options.UploadData ? "true" : "false")
+	     << ",\n  \"peakMemoryBytes\": " << peakMemory << ",\n  \"models\": [";
+	for (size_t m = 0; m < models.size(); ++m) {
+		const auto& model = models[m];
+		file << (m == 0 ? "\n" : ",\n") << "    {\n      \"path\": ";
+		WriteJsonString(file, model.Path.string());
+		file << ",\n      \"failures\": " << model.Failures << ",\n      \"stages\": [";
+		for (size_t s = 0; s < model.Stages.size(); ++s) {
+			const auto& stage = model.Stages[s];
+			file << (s == 0 ? "\n" : ",\n") << "        {\"path\": ";
+			WriteJsonString(file, stage.Path);
+			file << ", \"runs\": " << stage.Times.size() << ", \"minMs\": " << stage.Percentile(0.0) * 1000.0
+			     << ", \"medianMs\": " << stage.Percentile(0.5) * 1000.0 << ", \"p95Ms\": " << stage.Percentile(0.95) * 1000.0
+			     << ", \"bytes\": " << stage.Bytes << "}";
+		}
+		file << "\n      ]\n    }";
+	}
+	file << "\n  ]\n}\n";
+	if (!file.good()) { throw std::runtime_error("Failed to write benchmark results!"); }
+}
+
+int main(int argc, char** argv) {
+	size_t iterations = 10;
+	int maxDepth      = 2;
+	bool cold         = false;
+	std::filesystem::path jsonPath;
+	ModelLoadOptions options;
+	options.PrintProfile = false;
+	std::vector<std::filesystem::path> modelPaths;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--iterations" && i + 1 < argc) {
+			iterations = std::max<size_t>(std::stoull(argv[++i]), 1);
+		} else if (arg == "--depth" && i + 1 < argc) {
+			maxDepth = std::stoi(argv[++i]);
+		} else if (arg == "--no-upload") {
+			options.UploadData = false;
+		} else if (arg == "--cold") {
+			cold = true;
+		} else if (arg == "--json" && i + 1 < argc) {
+			jsonPath = argv[++i];
+		} else if (arg.starts_with("--")) {
+			std::cerr << "Unknown option '" << arg << "'." << std::endl;
+			return 1;
+		} else {
+			modelPaths.push_back(arg);
+		}
+	}
+	if (modelPaths.empty()) {
+		std::cerr << "Usage: " << argv[0]
+		          << " [--iterations N] [--depth N] [--no-upload] [--cold] [--json path] model.gltf..." << std::endl;
+		return 1;
+	}
+
+	// No window means no surface or swapchain, so the context needs no extensions beyond what Tsuki asks for itself.
+	tk::ContextHandle context;
+	tk::DeviceHandle device;
+	if (options.UploadData) {
+		context = tk::MakeHandle<tk::Context>();
+		device  = tk::MakeHandle<tk::Device>(*context);
+		std::cout << "Device: " << context->GetGPUInfo().Properties.Properties.deviceName.data() << "\n";
+	}
+	std::cout << "Iterations: " << iterations << (options.UploadData ? "" : ", imported without a device")
+	          << (cold ? ", caches cleared before every load" : "") << std::endl;
+
+	std::vector<ModelResults> models;
+	for (const auto& modelPath : modelPaths) {
+		auto& results = models.emplace_back();
+		results.Path  = modelPath;
+
+		for (size_t iteration = 0; iteration < iterations; ++iteration) {
+			if (cold) {
+				std::filesystem::remove_all(GeometryCache::GetCachePath(0).parent_path());
+				std::filesystem::remove_all(TextureCache::GetCachePath(0).parent_path());
+			}
+
+			try {
+				auto model = device ? std::make_unique<Model>(*device, modelPath, nullptr, options)
+				                    : std::make_unique<Model>(modelPath, nullptr, options);
+
+				// A texture without an image means every source it could have used failed to load, and the viewer cannot
+				// draw it. Count that as a failed load, so that models such as BasisuFallback catch regressions in which
+				// source is chosen.
+				size_t missingImages = 0;
+				for (const auto& texture : model->Textures) { missingImages += texture->Image ? 0 : 1; }
+				if (missingImages > 0) {
+					throw std::runtime_error(std::to_string(missingImages) + " textures have no image");
+				}
+				results.AddStage(model->LoadProfile.Total, "", 0, maxDepth);
+
+				// Uploads are only submitted by the time the model is constructed, so wait for them the same way the viewer
+				// does before it hands a model over.
+				if (device) {
+					ProfileTimer waitTimer;
+					tk::FenceHandle uploadFence;
+					device->Submit(device->RequestCommandBuffer(tk::CommandBufferType::AsyncTransfer), &uploadFence);
+					uploadFence->Wait();
+					results.AddSample("Wait for Uploads", "Wait for Uploads", 1, waitTimer.Get(), 0);
+				}
+			} catch (const std::exception& e) {
+				std::cerr << "Failed to load model from '" << modelPath.string() << "': " << e.what() << std::endl;
+				++results.Failures;
+			}
+
+			// Release everything the model created before the next iteration, so that it starts from the same state.
+			if (device) { device->WaitIdle(); }
+		}
+
+		PrintResults(results, iterations);
+	}
+
+	const uint64_t peakMemory = GetPeakMemoryUsage();
+	std::cout << "\nPeak Memory: " << std::fixed << std::setprecision(1) << peakMemory / (1024.0 * 1024.0) << "MiB"
+	          << std::endl;
+
+	if (!jsonPath.empty()) {
+		try {
+			SaveResults(jsonPath, models, iterations, options, peakMemory);
+			std::cout << "\nResults saved to '" << jsonPath.string() << "'." << std::endl;
+		} catch (const std::exception& e) {
+			std::cerr << "Failed to save results to '" << jsonPath.string() << "': " << e.what() << std::endl;
+			return 1;
+		}
+	}
+
+	size_t failures = 0;
+	for (const auto& results : models) { failures += results.Failures; }
+
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+#include "Keyframes.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#	define KEYFRAMES_SSE 1
+#	include <immintrin.h>
+#else
+#	define KEYFRAMES_SSE 0
+#endif
+
+// How many keys the cursor may step forward before we give up and search instead. Playback at a normal rate crosses at
+// most one or two keys per frame.
+static constexpr size_t MaxCursorSteps = 4;
+
+KeyframeInterval FindKeyframe(std::span<const float> times, float time, KeyframeCursor& cursor) {
+	const size_t count = times.size();
+	if (count < 2 || time <= times[0]) {
+		cursor.Index = 0;
+		return {};
+	}
+	if (time >= times[count - 1]) {
+		cursor.Index = count - 2;
+		return {.Index = count - 2, .Factor = 1.0f};
+	}
+
+	// From here on, times[0] < time < times[count - 1], so there is always an interval with times[i] <= time <
+	// times[i + 1].
+	size_t i   = cursor.Index;
+	bool found = false;
+	if (i + 1 < count && times[i] <= time) {
+		for (size_t step = 0; step < MaxCursorSteps && times[i + 1] <= time; ++step) { ++i; }
+		found = time < times[i + 1];
+	}
+	if (!found) { i = (std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1; }
+	cursor.Index = i;
+
+	return {.Index = i, .Factor = (time - times[i]) / (times[i + 1] - times[i])};
+}
+
+KeyframeBlend SlerpBlend(const float* key0, const float* key1, float t) {
+	float cosTheta = key0[0] * key1[0] + key0[1] * key1[1] + key0[2] * key1[2] + key0[3] * key1[3];
+
+	// q and -q are the same rotation, so flip the second key when that is the shorter way around.
+	float sign = 1.0f;
+	if (cosTheta < 0.0f) {
+		cosTheta = -cosTheta;
+		sign     = -1.0f;
+	}
+
+	// Close keys would divide by almost 0, and are near enough to a straight line to lerp instead.
+	float w0 = 1.0f - t;
+	float w1 = t;
+	if (cosTheta < 0.9995f) {
+		const float theta    = std::acos(cosTheta);
+		const float sinTheta = std::sin(theta);
+		w0                   = std::sin(w0 * theta) / sinTheta;
+		w1                   = std::sin(w1 * theta) / sinTheta;
+	}
+
+	return {.Keys = {key0, key1, key1, key1}, .Weights = {w0, sign * w1, 0.0f, 0.0f}};
+}
+
+void BlendKeyframes(std::span<const KeyframeBlend> blends, float* dst) {
+#if KEYFRAMES_SSE
+	for (const auto& blend : blends) {
+		const __m128 w = _mm_loadu_ps(blend.Weights);
+		__m128 v       = _mm_mul_ps(_mm_loadu_ps(blend.Keys[0]), _mm_shuffle_ps(w, w, _MM_SHUFFLE(0, 0, 0, 0)));
+		v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(blend.Keys[1]), _mm_shuffle_ps(w, w, _MM_SHUFFLE(1, 1, 1, 1))));
+		v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(blend.Keys[2]), _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 2, 2))));
+		v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(blend.Keys[3]), _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 3, 3))));
+		_mm_storeu_ps(dst, v);
+		dst += 4;
+	}
+#else
+	for (const auto& blend : blends) {
+		for (int c = 0; c < 4; ++c) {
+			dst[c] = blend.Keys[0][c] * blend.Weights[0] + blend.Keys[1][c] * blend.Weights[1] +
+			         blend.Keys[2][c] * blend.Weights[2] + blend.Keys[3][c] * blend.Weights[3];
+		}
+		dst += 4;
+	}
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+// Keyframe lookup and interpolation for animation samplers. Keyframe values are stored as four floats each, whatever
+// their type, so that every key is one SIMD register. Cubic spline samplers keep the layout glTF gives them, an
+// in-tangent, value and out-tangent for every key, which places the four vectors one segment blends next to each other.
+
+// Remembers where the last lookup in a keyframe track landed. Playback moves forward through a track a little at a
+// time, so the next lookup usually only has to check the key after the cursor instead of searching the whole track.
+struct KeyframeCursor {
+	size_t Index = 0;
+};
+
+// A pair of consecutive keyframes, and how far between them a time is.
+struct KeyframeInterval {
+	size_t Index = 0;     // The first of the two keyframes.
+	float Factor = 0.0f;  // From 0 at the first keyframe to 1 at the second.
+};
+
+// Find the keyframes surrounding the given time in a track of increasing key times. Times before the first key or after
+// the last are clamped to them. The cursor is checked first, along with the few keys after it, and the track is only
+// binary searched when that fails, such as after a seek or when the animation loops.
+//
+// Tracks with fewer than two keys always return the first key with a factor of 0.
+KeyframeInterval FindKeyframe(std::span<const float> times, float time, KeyframeCursor& cursor);
+
+// A sampled value, written as a weighted sum of up to four keyframe vectors. Every kind of interpolation glTF uses can
+// be written this way, so that the values of many channels can be computed together by BlendKeyframes once their
+// weights are known. Unused keys have a weight of 0, and must still point at valid data.
+struct KeyframeBlend {
+	const float* Keys[4] = {};
+	float Weights[4]     = {};
+};
+
+// Hold the value of a single key.
+inline KeyframeBlend StepBlend(const float* key) {
+	return {.Keys = {key, key, key, key}, .Weights = {1.0f, 0.0f, 0.0f, 0.0f}};
+}
+
+// Interpolate linearly from one key to the next.
+inline KeyframeBlend LerpBlend(const float* key0, const float* key1, float t) {
+	return {.Keys = {key0, key1, key1, key1}, .Weights = {1.0f - t, t, 0.0f, 0.0f}};
+}
+
+// Interpolate between two unit quaternions along the shorter arc. The result is unit length up to rounding, and should
+// be normalized once blended.
+KeyframeBlend SlerpBlend(const float* key0, const float* key1, float t);
+// Interpolate along a cubic Hermite spline segment. The segment points at four consecutive vectors: the first key's
+// value and out-tangent, then the second key's in-tangent and value. Duration is the time between the two keys, which
+// the tangents are scaled by.
+inline KeyframeBlend HermiteBlend(const float* segment, float t, float duration) {
+	const float t2 = t * t;
+	const float t3 = t2 * t;
+
+	return {.Keys    = {segment, segment + 4, segment + 8, segment + 12},
+	        .Weights = {2.0f * t3 - 3.0f * t2 + 1.0f,
+	                    (t3 - 2.0f * t2 + t) * duration,
+	                    (t3 - t2) * duration,
+	                    -2.0f * t3 + 3.0f * t2}};
+}
+
+// Evaluate blends into tightly packed four-float vectors, one per blend. Uses SSE where available.
+void BlendKeyframes(std::span<const KeyframeBlend> blends, float* dst);
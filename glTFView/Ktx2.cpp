@@ -0,0 +1,107 @@
+#include "Ktx2.hpp"
+
+#include <Tsuki/TextureFormat.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+constexpr uint8_t Ktx2Identifier[12] = {0xab, 0x4b, 0x54, 0x58, 0x20, 0x32, 0x30, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a};
+
+enum class Ktx2Supercompression : uint32_t { None = 0, BasisLZ = 1, Zstandard = 2, Zlib = 3 };
+
+// The header and index which follow the identifier, as laid out in the file. The supercompression global data fields
+// are 64-bit but only 4-byte aligned, so they are split in two to keep the struct free of padding.
+struct Ktx2Header {
+	uint32_t VkFormat;
+	uint32_t TypeSize;
+	uint32_t PixelWidth;
+	uint32_t PixelHeight;
+	uint32_t PixelDepth;
+	uint32_t LayerCount;
+	uint32_t FaceCount;
+	uint32_t LevelCount;
+	uint32_t SupercompressionScheme;
+	uint32_t DfdByteOffset;
+	uint32_t DfdByteLength;
+	uint32_t KvdByteOffset;
+	uint32_t KvdByteLength;
+	uint32_t SgdByteOffset[2];
+	uint32_t SgdByteLength[2];
+};
+static_assert(sizeof(Ktx2Header) == 68);
+
+struct Ktx2LevelIndex {
+	uint64_t ByteOffset;
+	uint64_t ByteLength;
+	uint64_t UncompressedByteLength;
+};
+static_assert(sizeof(Ktx2LevelIndex) == 24);
+}  // namespace
+
+bool IsKtx2(const uint8_t* data, size_t size) {
+	return size >= sizeof(Ktx2Identifier) && std::memcmp(data, Ktx2Identifier, sizeof(Ktx2Identifier)) == 0;
+}
+
+Ktx2Image ParseKtx2(const uint8_t* data, size_t size) {
+	if (!IsKtx2(data, size)) { throw std::runtime_error("Not a KTX2 file"); }
+	if (size < sizeof(Ktx2Identifier) + sizeof(Ktx2Header)) { throw std::runtime_error("KTX2 header is truncated"); }
+
+	Ktx2Header header;
+	std::memcpy(&header, data + sizeof(Ktx2Identifier), sizeof(header));
+
+	const auto supercompression = static_cast<Ktx2Supercompression>(header.SupercompressionScheme);
+	if (header.VkFormat == 0 || supercompression == Ktx2Supercompression::BasisLZ) {
+		throw std::runtime_error("KTX2 texture holds Basis Universal data, which must be transcoded and is not supported");
+	}
+	if (supercompression != Ktx2Supercompression::None) {
+		throw std::runtime_error("KTX2 texture uses supercompression scheme " +
+		                         std::to_string(header.SupercompressionScheme) + ", which is not supported");
+	}
+	if (header.PixelWidth == 0 || header.PixelHeight == 0 || header.PixelDepth > 1 || header.LayerCount > 1 ||
+	    header.FaceCount != 1) {
+		throw std::runtime_error("KTX2 texture is not a single 2D image");
+	}
+
+	Ktx2Image image{.Format          = static_cast<vk::Format>(header.VkFormat),
+	                .Width           = header.PixelWidth,
+	                .Height          = header.PixelHeight,
+	                .GenerateMipmaps = header.LevelCount == 0};
+
+	uint32_t blockWidth, blockHeight;
+	tk::TextureFormatLayout::FormatBlockDim(image.Format, blockWidth, blockHeight);
+	const uint32_t blockSize = tk::TextureFormatLayout::FormatBlockSize(image.Format, vk::ImageAspectFlagBits::eColor);
+	if (blockSize == 0) {
+		throw std::runtime_error("KTX2 texture has unsupported format " + vk::to_string(image.Format));
+	}
+
+	const uint32_t levelCount = std::max(header.LevelCount, 1u);
+	if (levelCount > tk::TextureFormatLayout::MipLevels(image.Width, image.Height)) {
+		throw std::runtime_error("KTX2 texture has more mip levels than its size allows");
+	}
+	const size_t levelIndexOffset = sizeof(Ktx2Identifier) + sizeof(Ktx2Header);
+	if (size < levelIndexOffset + levelCount * sizeof(Ktx2LevelIndex)) {
+		throw std::runtime_error("KTX2 level index is truncated");
+	}
+
+	image.Levels.resize(levelCount);
+	for (uint32_t level = 0; level < levelCount; ++level) {
+		Ktx2LevelIndex levelIndex;
+		std::memcpy(&levelIndex, data + levelIndexOffset + level * sizeof(Ktx2LevelIndex), sizeof(levelIndex));
+
+		// Without supercompression, each level holds exactly its blocks, row after row.
+		const uint32_t width    = std::max(image.Width >> level, 1u);
+		const uint32_t height   = std::max(image.Height >> level, 1u);
+		const uint64_t expected =
+			uint64_t((width + blockWidth - 1) / blockWidth) * ((height + blockHeight - 1) / blockHeight) * blockSize;
+		if (levelIndex.ByteLength < expected || levelIndex.ByteOffset > size ||
+		    levelIndex.ByteLength > size - levelIndex.ByteOffset) {
+			throw std::runtime_error("KTX2 mip level " + std::to_string(level) + " is truncated");
+		}
+
+		image.Levels[level] = {.Data = data + levelIndex.ByteOffset, .Size = static_cast<size_t>(levelIndex.ByteLength)};
+	}
+
+	return image;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Tsuki/Common.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A 2D texture read from a KTX2 container. The level data points into the container, so it is only valid for as long
+// as the container's bytes are.
+struct Ktx2Image {
+	struct Level {
+		const uint8_t* Data = nullptr;
+		size_t Size         = 0;
+	};
+
+	vk::Format Format = vk::Format::eUndefined;
+	uint32_t Width    = 0;
+	uint32_t Height   = 0;
+	// From the full size image down. Each level is tightly packed, as TextureFormatLayout expects.
+	std::vector<Level> Levels;
+	// The container only holds the base level and asks for the rest of the mip chain to be generated on load.
+	bool GenerateMipmaps = false;
+};
+
+// Whether the given bytes start with the KTX2 file identifier.
+bool IsKtx2(const uint8_t* data, size_t size);
+
+// Parse a KTX2 container holding a single 2D texture whose payload is already in a format the GPU can sample, such as
+// BCn. Supercompressed containers, including those holding Basis Universal data (KHR_texture_basisu), need transcoding
+// and are rejected. Throws std::runtime_error describing why a container could not be read.
+Ktx2Image ParseKtx2(const uint8_t* data, size_t size);
@@ -0,0 +1,122 @@
+#include "LoadProfile.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+static constexpr double MiB = 1024.0 * 1024.0;
+
+LoadProfileStage& LoadProfileStage::Add(std::string name, double time, uint64_t bytes, uint64_t count) {
+	return Children.emplace_back(std::move(name), time, bytes, count);
+}
+
+double LoadProfileStage::Throughput() const {
+	if (Bytes == 0 || Time <= 0.0) { return 0.0; }
+
+	return double(Bytes) / Time;
+}
+
+static void PrintStage(std::ostream& out, const LoadProfileStage& stage, int depth) {
+	out << std::string(depth, '\t') << stage.Name << ": " << stage.Time * 1000.0 << "ms";
+
+	std::vector<std::string> details;
+	if (stage.Count > 0) { details.push_back(std::to_string(stage.Count) + " items"); }
+	if (stage.Bytes > 0) {
+		std::ostringstream bytes;
+		bytes << stage.Bytes / MiB << "MiB";
+		if (stage.Throughput() > 0.0) { bytes << " at " << stage.Throughput() / MiB << "MiB/s"; }
+		details.push_back(bytes.str());
+	}
+	if (!stage.Note.empty()) { details.push_back(stage.Note); }
+	for (size_t i = 0; i < details.size(); ++i) { out << (i == 0 ? " (" : ", ") << details[i]; }
+	if (!details.empty()) { out << ")"; }
+	out << "\n";
+
+	for (const auto& child : stage.Children) { PrintStage(out, child, depth + 1); }
+}
+
+void ModelLoadProfile::Print(std::ostream& out) const {
+	out << "\tLoading completed in " << Total.Time * 1000.0 << "ms.\n";
+	for (const auto& stage : Total.Children) { PrintStage(out, stage, 2); }
+	out.flush();
+}
+
+void WriteJsonString(std::ostream& out, const std::string& str) {
+	out << '"';
+	for (const char c : str) {
+		switch (c) {
+			case '"':
+				out << "\\\"";
+				break;
+			case '\\':
+				out << "\\\\";
+				break;
+			case '\n':
+				out << "\\n";
+				break;
+			case '\r':
+				out << "\\r";
+				break;
+			case '\t':
+				out << "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char escaped[8];
+					snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+					out << escaped;
+				} else {
+					out << c;
+				}
+				break;
+		}
+	}
+	out << '"';
+}
+
+static void WriteJsonStage(std::ostream& out, const LoadProfileStage& stage, int depth) {
+	const std::string indent(depth * 2, ' ');
+	out << "{\n" << indent << "  \"name\": ";
+	WriteJsonString(out, stage.Name);
+	out << ",\n" << indent << "  \"timeMs\": " << stage.Time * 1000.0;
+	out << ",\n" << indent << "  \"bytes\": " << stage.Bytes;
+	out << ",\n" << indent << "  \"count\": " << stage.Count;
+	out << ",\n" << indent << "  \"bytesPerSecond\": " << stage.Throughput();
+	if (!stage.Note.empty()) {
+		out << ",\n" << indent << "  \"note\": ";
+		WriteJsonString(out, stage.Note);
+	}
+	if (!stage.Children.empty()) {
+		out << ",\n" << indent << "  \"children\": [";
+		for (size_t i = 0; i < stage.Children.size(); ++i) {
+			out << (i == 0 ? "\n" : ",\n") << indent << "    ";
+			WriteJsonStage(out, stage.Children[i], depth + 2);
+		}
+		out << "\n" << indent << "  ]";
+	}
+	out << "\n" << indent << "}";
+}
+
+std::string ModelLoadProfile::ToJson() const {
+	std::ostringstream out;
+	out.precision(9);
+	out << "{\n  \"model\": ";
+	WriteJsonString(out, ModelName);
+	out << ",\n  \"source\": ";
+	WriteJsonString(out, SourcePath);
+	out << ",\n  \"stages\": ";
+	WriteJsonStage(out, Total, 1);
+	out << "\n}\n";
+
+	return out.str();
+}
+
+void ModelLoadProfile::SaveJson(const std::filesystem::path& jsonPath) const {
+	if (jsonPath.has_parent_path()) { std::filesystem::create_directories(jsonPath.parent_path()); }
+
+	std::ofstream file(jsonPath, std::ios::trunc);
+	if (!file.is_open()) { throw std::runtime_error("Failed to open file for writing!"); }
+	file << ToJson();
+	if (!file.good()) { throw std::runtime_error("Failed to write load profile!"); }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// One stage of loading a model, and the stages it is made of. Stages run on the loading thread report the wall-clock
+// time they took. Stages whose work is spread across the thread pool report the sum of the time every task spent on
+// them instead, so they can add up to more than their parent.
+struct LoadProfileStage {
+	LoadProfileStage() = default;
+	LoadProfileStage(std::string name, double time, uint64_t bytes = 0, uint64_t count = 0)
+			: Name(std::move(name)), Time(time), Bytes(bytes), Count(count) {}
+
+	// Append a child stage, returning it so that it can be given children of its own.
+	LoadProfileStage& Add(std::string name, double time, uint64_t bytes = 0, uint64_t count = 0);
+	// The rate the stage processed its data at, in bytes per second, or 0 if it does not process data.
+	double Throughput() const;
+
+	std::string Name;
+	double Time    = 0.0;  // Seconds.
+	uint64_t Bytes = 0;    // How much data the stage read or produced, or 0 if that does not apply.
+	uint64_t Count = 0;    // How many items (images, meshes, nodes...) the stage handled, or 0 if that does not apply.
+	std::string Note;      // Anything else worth knowing, such as how much an optimization helped.
+	std::vector<LoadProfileStage> Children;
+};
+
+// How long every stage of loading a model took, and how much data each stage handled. Kept with the model so that it
+// can be inspected after loading, and exported as JSON so that import times can be compared across versions.
+struct ModelLoadProfile {
+	// Print the stages as an indented tree.
+	void Print(std::ostream& out) const;
+	std::string ToJson() const;
+	void SaveJson(const std::filesystem::path& jsonPath) const;
+
+	std::string ModelName;
+	std::string SourcePath;
+	LoadProfileStage Total;
+};
+
+// Write a string as a quoted JSON string, escaping anything which needs it.
+void WriteJsonString(std::ostream& out, const std::string& str);
@@ -0,0 +1,460 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+static glm::vec3 GetPosition(const float* positions, size_t positionStride, uint32_t index) {
+	const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + index * positionStride);
+	return glm::vec3(p[0], p[1], p[2]);
+}
+
+// Count how many vertices of each triangle miss a FIFO vertex cache.
+static std::vector<uint8_t> SimulateTriangleMisses(std::span<const uint32_t> indices,
+                                                   size_t vertexCount,
+                                                   uint32_t cacheSize) {
+	const size_t triangleCount = indices.size() / 3;
+	std::vector<uint8_t> misses(triangleCount, 0);
+	std::vector<size_t> cacheTimestamps(vertexCount, 0);
+	size_t timestamp = cacheSize + 1;
+	for (size_t t = 0; t < triangleCount; ++t) {
+		for (size_t k = 0; k < 3; ++k) {
+			const uint32_t index = indices[t * 3 + k];
+			if (timestamp - cacheTimestamps[index] > cacheSize) {
+				cacheTimestamps[index] = timestamp++;
+				misses[t]++;
+			}
+		}
+	}
+
+	return misses;
+}
+
+VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+	VertexCacheStats stats{.Triangles = indices.size() / 3};
+
+	// Rather than shifting a FIFO around, remember when each vertex last entered the cache. A vertex is still cached if
+	// fewer than cacheSize vertices have entered since.
+	std::vector<size_t> cacheTimestamps(vertexCount, 0);
+	std::vector<bool> used(vertexCount, false);
+	size_t timestamp = cacheSize + 1;
+	for (const auto index : indices) {
+		if (timestamp - cacheTimestamps[index] > cacheSize) {
+			cacheTimestamps[index] = timestamp++;
+			stats.TransformedVertices++;
+		}
+		if (!used[index]) {
+			used[index] = true;
+			stats.Vertices++;
+		}
+	}
+
+	return stats;
+}
+
+/* ==================================
+** === Forsyth Vertex Cache Order ===
+   ================================== */
+static constexpr uint32_t ForsythCacheSize     = 32;
+static constexpr uint32_t ForsythMaxValence    = 32;
+static constexpr float ForsythCacheDecay       = 1.5f;
+static constexpr float ForsythLastTriScore     = 0.75f;
+static constexpr float ForsythValenceScale     = 2.0f;
+static constexpr float ForsythValencePower     = 0.5f;
+static constexpr uint32_t InvalidCachePosition = std::numeric_limits<uint32_t>::max();
+
+struct ForsythTables {
+	ForsythTables() {
+		for (uint32_t i = 0; i < ForsythCacheSize; ++i) {
+			if (i < 3) {
+				// The most recent triangle's vertices get a fixed score, so that the algorithm doesn't simply favour the
+				// triangle it just emitted, which would result in strips rather than fans.
+				Cache[i] = ForsythLastTriScore;
+			} else {
+				const float scaler = 1.0f / float(ForsythCacheSize - 3);
+				Cache[i]           = std::pow(1.0f - float(i - 3) * scaler, ForsythCacheDecay);
+			}
+		}
+		Valence[0] = 0.0f;
+		for (uint32_t i = 1; i <= ForsythMaxValence; ++i) {
+			Valence[i] = ForsythValenceScale * std::pow(float(i), -ForsythValencePower);
+		}
+	}
+
+	float Cache[ForsythCacheSize];
+	float Valence[ForsythMaxValence + 1];
+};
+static const ForsythTables ForsythScores;
+
+static float ForsythVertexScore(uint32_t cachePosition, uint32_t remainingValence) {
+	// Vertices with no triangles left are of no further use.
+	if (remainingValence == 0) { return -1.0f; }
+
+	float score = 0.0f;
+	if (cachePosition < ForsythCacheSize) { score += ForsythScores.Cache[cachePosition]; }
+	// Boost vertices with few triangles left, so that lone triangles are cleared up rather than left behind.
+	score += ForsythScores.Valence[std::min(remainingValence, ForsythMaxValence)];
+
+	return score;
+}
+
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2 || vertexCount == 0) { return; }
+
+	// Build the vertex to triangle adjacency, as offsets into a single shared list.
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; ++i) { adjacencyOffsets[indices[i] + 1]++; }
+	for (size_t v = 0; v < vertexCount; ++v) { adjacencyOffsets[v + 1] += adjacencyOffsets[v]; }
+	std::vector<uint32_t> remainingValence(vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v) { remainingValence[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v]; }
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t t = 0; t < triangleCount; ++t) {
+			for (size_t k = 0; k < 3; ++k) { adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t); }
+		}
+	}
+
+	std::vector<uint32_t> cachePositions(vertexCount, InvalidCachePosition);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v) {
+		vertexScores[v] = ForsythVertexScore(InvalidCachePosition, remainingValence[v]);
+	}
+
+	std::vector<float> triangleScores(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	for (size_t t = 0; t < triangleCount; ++t) {
+		triangleScores[t] =
+			vertexScores[indices[t * 3 + 0]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+	}
+
+	// The simulated LRU cache has room for the three vertices of the newest triangle to push older vertices out.
+	uint32_t cache[ForsythCacheSize + 3];
+	uint32_t cacheCount = 0;
+
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+
+	size_t bestTriangle = 0;
+	for (size_t t = 1; t < triangleCount; ++t) {
+		if (triangleScores[t] > triangleScores[bestTriangle]) { bestTriangle = t; }
+	}
+	size_t scanCursor = 0;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+		// If no triangle touching the cache was worth picking, fall back to the next unemitted triangle in input order.
+		if (bestTriangle == std::numeric_limits<size_t>::max()) {
+			while (emitted[scanCursor]) { ++scanCursor; }
+			bestTriangle = scanCursor;
+		}
+
+		const uint32_t* tri = &indices[bestTriangle * 3];
+		output.insert(output.end(), tri, tri + 3);
+		emitted[bestTriangle] = true;
+
+		// Remove the triangle from its vertices' adjacency lists.
+		for (size_t k = 0; k < 3; ++k) {
+			const uint32_t v        = tri[k];
+			uint32_t* list          = &adjacency[adjacencyOffsets[v]];
+			const uint32_t listSize = remainingValence[v];
+			for (uint32_t i = 0; i < listSize; ++i) {
+				if (list[i] == bestTriangle) {
+					list[i] = list[listSize - 1];
+					break;
+				}
+			}
+			remainingValence[v]--;
+		}
+
+		// Move the triangle's vertices to the front of the cache, pushing everything else back.
+		uint32_t newCache[ForsythCacheSize + 3];
+		uint32_t newCacheCount = 0;
+		for (size_t k = 0; k < 3; ++k) { newCache[newCacheCount++] = tri[k]; }
+		for (uint32_t i = 0; i < cacheCount; ++i) {
+			const uint32_t v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2]) { newCache[newCacheCount++] = v; }
+		}
+
+		// Rescore every vertex which was in the cache, and every triangle that uses one of them. Vertices which fell out of
+		// the cache are included here so their score drops accordingly.
+		for (uint32_t i = 0; i < newCacheCount; ++i) {
+			const uint32_t v  = newCache[i];
+			cachePositions[v] = i < ForsythCacheSize ? i : InvalidCachePosition;
+		}
+		for (uint32_t i = 0; i < newCacheCount; ++i) {
+			const uint32_t v     = newCache[i];
+			const float newScore = ForsythVertexScore(cachePositions[v], remainingValence[v]);
+			const float delta    = newScore - vertexScores[v];
+			vertexScores[v]      = newScore;
+
+			const uint32_t* list = &adjacency[adjacencyOffsets[v]];
+			for (uint32_t j = 0; j < remainingValence[v]; ++j) { triangleScores[list[j]] += delta; }
+		}
+
+		// The next triangle is the best scoring one touching the cache.
+		bestTriangle    = std::numeric_limits<size_t>::max();
+		float bestScore = -1.0f;
+		cacheCount      = std::min(newCacheCount, ForsythCacheSize);
+		for (uint32_t i = 0; i < cacheCount; ++i) {
+			const uint32_t v     = newCache[i];
+			cache[i]             = v;
+			const uint32_t* list = &adjacency[adjacencyOffsets[v]];
+			for (uint32_t j = 0; j < remainingValence[v]; ++j) {
+				const uint32_t t = list[j];
+				if (triangleScores[t] > bestScore) {
+					bestScore    = triangleScores[t];
+					bestTriangle = t;
+				}
+			}
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+
+/* ================
+** === Overdraw ===
+   ================ */
+static constexpr int OverdrawResolution = 256;
+
+OverdrawStats AnalyzeOverdraw(std::span<const uint32_t> indices,
+                              const float* positions,
+                              size_t vertexCount,
+                              size_t positionStride) {
+	OverdrawStats stats;
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) { return stats; }
+
+	glm::vec3 boundsMin(std::numeric_limits<float>::max());
+	glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+	for (const auto index : indices) {
+		const glm::vec3 p = GetPosition(positions, positionStride, index);
+		boundsMin         = glm::min(boundsMin, p);
+		boundsMax         = glm::max(boundsMax, p);
+	}
+	const glm::vec3 extent = boundsMax - boundsMin;
+	const float scale      = std::max({extent.x, extent.y, extent.z});
+	if (scale <= 0.0f) { return stats; }
+
+	std::vector<float> depthBuffer(OverdrawResolution * OverdrawResolution);
+	std::vector<glm::vec3> projected(triangleCount * 3);
+
+	// Look at the mesh along each axis, from both sides.
+	for (int axis = 0; axis < 3; ++axis) {
+		for (const float direction : {1.0f, -1.0f}) {
+			const int uAxis = (axis + 1) % 3;
+			const int vAxis = (axis + 2) % 3;
+
+			// Smaller depths are closer to the viewer.
+			constexpr float pixelScale = float(OverdrawResolution - 1);
+			for (size_t i = 0; i < triangleCount * 3; ++i) {
+				const glm::vec3 p = (GetPosition(positions, positionStride, indices[i]) - boundsMin) / scale;
+				projected[i]      = glm::vec3(p[uAxis] * pixelScale, p[vAxis] * pixelScale, p[axis] * direction);
+			}
+
+			std::fill(depthBuffer.begin(), depthBuffer.end(), std::numeric_limits<float>::max());
+			for (size_t t = 0; t < triangleCount; ++t) {
+				glm::vec3 a = projected[t * 3 + 0];
+				glm::vec3 b = projected[t * 3 + 1];
+				glm::vec3 c = projected[t * 3 + 2];
+
+				// The signed screen area is the triangle's normal along the view axis. Triangles facing the same way the view
+				// looks are back faces.
+				const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+				if (area * direction >= 0.0f) { continue; }
+				if (area < 0.0f) { std::swap(b, c); }
+
+				const int minX      = std::max(0, int(std::ceil(std::min({a.x, b.x, c.x}))));
+				const int minY      = std::max(0, int(std::ceil(std::min({a.y, b.y, c.y}))));
+				const int maxX      = std::min(OverdrawResolution - 1, int(std::floor(std::max({a.x, b.x, c.x}))));
+				const int maxY      = std::min(OverdrawResolution - 1, int(std::floor(std::max({a.y, b.y, c.y}))));
+				const float invArea = 1.0f / std::abs(area);
+
+				for (int y = minY; y <= maxY; ++y) {
+					for (int x = minX; x <= maxX; ++x) {
+						const float px = float(x);
+						const float py = float(y);
+						const float w0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+						const float w1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+						const float w2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+						if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) { continue; }
+
+						const float depth = (w0 * a.z + w1 * b.z + w2 * c.z) * invArea;
+						float& stored     = depthBuffer[y * OverdrawResolution + x];
+						if (depth < stored) {
+							if (stored == std::numeric_limits<float>::max()) { stats.PixelsCovered++; }
+							stored = depth;
+							stats.PixelsShaded++;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return stats;
+}
+
+void OptimizeOverdraw(std::span<uint32_t> indices,
+                      const float* positions,
+                      size_t vertexCount,
+                      size_t positionStride,
+                      float threshold) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2 || vertexCount == 0) { return; }
+
+	// Hard boundaries: triangles whose vertices all miss the cache. Reordering whole runs between these costs nothing.
+	const auto misses = SimulateTriangleMisses(indices, vertexCount, 16);
+	std::vector<size_t> hardClusters;
+	for (size_t t = 0; t < triangleCount; ++t) {
+		if (t == 0 || misses[t] == 3) { hardClusters.push_back(t); }
+	}
+	hardClusters.push_back(triangleCount);
+
+	// Soft boundaries: split each run further once the triangles so far, starting from a cold cache, have a miss ratio
+	// close enough to the run's as a whole. Splitting here only costs the few extra misses of warming the cache up again.
+	constexpr uint32_t cacheSize = 16;
+	std::vector<size_t> cacheTimestamps(vertexCount, 0);
+	size_t timestamp = cacheSize + 1;
+	std::vector<size_t> clusters;
+	for (size_t h = 0; h + 1 < hardClusters.size(); ++h) {
+		const size_t begin = hardClusters[h];
+		const size_t end   = hardClusters[h + 1];
+
+		size_t hardMisses = 0;
+		for (size_t t = begin; t < end; ++t) { hardMisses += misses[t]; }
+		const float hardACMR = float(hardMisses) / float(end - begin);
+
+		clusters.push_back(begin);
+		size_t runMisses = 0;
+		size_t runStart  = begin;
+		timestamp += cacheSize + 1;
+		for (size_t t = begin; t < end; ++t) {
+			for (size_t k = 0; k < 3; ++k) {
+				const uint32_t index = indices[t * 3 + k];
+				if (timestamp - cacheTimestamps[index] > cacheSize) {
+					cacheTimestamps[index] = timestamp++;
+					runMisses++;
+				}
+			}
+
+			const float runACMR = float(runMisses) / float(t - runStart + 1);
+			if (t + 1 < end && runACMR <= hardACMR * threshold) {
+				clusters.push_back(t + 1);
+				runStart  = t + 1;
+				runMisses = 0;
+				timestamp += cacheSize + 1;
+			}
+		}
+	}
+	clusters.push_back(triangleCount);
+	const size_t clusterCount = clusters.size() - 1;
+
+	// Find the area weighted center of the mesh, and of each cluster along with its average normal.
+	std::vector<glm::vec3> clusterCenters(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+	for (size_t c = 0; c < clusterCount; ++c) {
+		float clusterArea = 0.0f;
+		for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+			const glm::vec3 p0 = GetPosition(positions, positionStride, indices[t * 3 + 0]);
+			const glm::vec3 p1 = GetPosition(positions, positionStride, indices[t * 3 + 1]);
+			const glm::vec3 p2 = GetPosition(positions, positionStride, indices[t * 3 + 2]);
+
+			const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			const float area       = glm::length(normal);
+			clusterCenters[c] += (p0 + p1 + p2) * (area / 3.0f);
+			clusterNormals[c] += normal;
+			clusterArea += area;
+		}
+		meshCenter += clusterCenters[c];
+		meshArea += clusterArea;
+		if (clusterArea > 0.0f) { clusterCenters[c] /= clusterArea; }
+	}
+	if (meshArea > 0.0f) { meshCenter /= meshArea; }
+
+	// Clusters which are far out along the direction they face are likely to occlude the rest of the mesh, so draw them
+	// first.
+	std::vector<float> clusterSortKeys(clusterCount);
+	for (size_t c = 0; c < clusterCount; ++c) {
+		const float normalLength = glm::length(clusterNormals[c]);
+		clusterSortKeys[c] =
+			normalLength > 0.0f ? glm::dot(clusterCenters[c] - meshCenter, clusterNormals[c] / normalLength) : 0.0f;
+	}
+	std::vector<size_t> clusterOrder(clusterCount);
+	std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](size_t a, size_t b) {
+		return clusterSortKeys[a] > clusterSortKeys[b];
+	});
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (const auto c : clusterOrder) {
+		output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+	}
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+
+/* ====================
+** === Vertex Fetch ===
+   ==================== */
+static constexpr size_t FetchCacheLineSize  = 64;
+static constexpr size_t FetchCacheLineCount = 256;
+
+VertexFetchStats AnalyzeVertexFetch(std::span<const uint32_t> indices, size_t vertexCount, size_t vertexSize) {
+	VertexFetchStats stats;
+
+	// Only vertices which miss the post-transform cache are fetched.
+	constexpr uint32_t cacheSize = 16;
+	std::vector<size_t> cacheTimestamps(vertexCount, 0);
+	std::vector<bool> used(vertexCount, false);
+	size_t timestamp = cacheSize + 1;
+
+	std::vector<size_t> lineTags(FetchCacheLineCount, std::numeric_limits<size_t>::max());
+	for (const auto index : indices) {
+		if (!used[index]) {
+			used[index] = true;
+			stats.BytesUsed += vertexSize;
+		}
+		if (timestamp - cacheTimestamps[index] <= cacheSize) { continue; }
+		cacheTimestamps[index] = timestamp++;
+
+		const size_t firstLine = (index * vertexSize) / FetchCacheLineSize;
+		const size_t lastLine  = (index * vertexSize + vertexSize - 1) / FetchCacheLineSize;
+		for (size_t line = firstLine; line <= lastLine; ++line) {
+			size_t& tag = lineTags[line % FetchCacheLineCount];
+			if (tag != line) {
+				tag = line;
+				stats.BytesFetched += FetchCacheLineSize;
+			}
+		}
+	}
+
+	return stats;
+}
+
+void OptimizeVertexFetch(std::span<uint32_t> indices, void* vertices, size_t vertexCount, size_t vertexSize) {
+	constexpr uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+
+	std::vector<uint32_t> remap(vertexCount, unassigned);
+	uint32_t nextVertex = 0;
+	for (auto& index : indices) {
+		if (remap[index] == unassigned) { remap[index] = nextVertex++; }
+		index = remap[index];
+	}
+	for (auto& newIndex : remap) {
+		if (newIndex == unassigned) { newIndex = nextVertex++; }
+	}
+
+	uint8_t* vertexData = reinterpret_cast<uint8_t*>(vertices);
+	std::vector<uint8_t> original(vertexData, vertexData + vertexCount * vertexSize);
+	for (size_t v = 0; v < vertexCount; ++v) {
+		memcpy(vertexData + remap[v] * vertexSize, original.data() + v * vertexSize, vertexSize);
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Statistics from simulating a FIFO post-transform vertex cache over an index buffer. These are plain counts so that
+// results for several index buffers can be added together.
+struct VertexCacheStats {
+	size_t TransformedVertices = 0;
+	size_t Triangles           = 0;
+	size_t Vertices            = 0;
+
+	// Average cache miss ratio: vertices transformed per triangle. 0.5 is the best possible, 3.0 is the worst.
+	double ACMR() const {
+		return Triangles ? double(TransformedVertices) / double(Triangles) : 0.0;
+	}
+	// Average transform to vertex ratio: vertices transformed per unique vertex. 1.0 is the best possible.
+	double ATVR() const {
+		return Vertices ? double(TransformedVertices) / double(Vertices) : 0.0;
+	}
+
+	VertexCacheStats& operator+=(const VertexCacheStats& other) {
+		TransformedVertices += other.TransformedVertices;
+		Triangles += other.Triangles;
+		Vertices += other.Vertices;
+		return *this;
+	}
+};
+
+// Statistics from rasterizing a triangle list from several directions around its bounds, with depth testing and back
+// face culling. Overdraw is the number of fragments which pass the depth test per covered pixel, and depends on the
+// order triangles are drawn in.
+struct OverdrawStats {
+	size_t PixelsCovered = 0;
+	size_t PixelsShaded  = 0;
+
+	double Overdraw() const {
+		return PixelsCovered ? double(PixelsShaded) / double(PixelsCovered) : 0.0;
+	}
+
+	OverdrawStats& operator+=(const OverdrawStats& other) {
+		PixelsCovered += other.PixelsCovered;
+		PixelsShaded += other.PixelsShaded;
+		return *this;
+	}
+};
+
+// Statistics from simulating the memory traffic of vertex fetch, through a small direct mapped cache of 64-byte lines.
+struct VertexFetchStats {
+	size_t BytesFetched = 0;
+	size_t BytesUsed    = 0;
+
+	// Bytes fetched per byte of vertex data used. 1.0 is the best possible.
+	double Overfetch() const {
+		return BytesUsed ? double(BytesFetched) / double(BytesUsed) : 0.0;
+	}
+
+	VertexFetchStats& operator+=(const VertexFetchStats& other) {
+		BytesFetched += other.BytesFetched;
+		BytesUsed += other.BytesUsed;
+		return *this;
+	}
+};
+
+// Simulate a FIFO vertex cache of the given size over a triangle list.
+VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+// Reorder the triangles of a triangle list to make the most of the GPU's post-transform vertex cache, using Tom
+// Forsyth's "Linear-Speed Vertex Cache Optimisation". The triangles themselves and their winding are unchanged.
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount);
+
+// Measure overdraw for a triangle list. Positions are three floats, positionStride bytes apart.
+OverdrawStats AnalyzeOverdraw(std::span<const uint32_t> indices,
+                              const float* positions,
+                              size_t vertexCount,
+                              size_t positionStride);
+
+// Reorder a triangle list, which should already be optimized for the vertex cache, to reduce overdraw. The triangles
+// are split into clusters at points where the vertex cache would be cold anyway, and the clusters are then sorted so
+// that those facing outward from the center of the mesh are drawn first. Clusters are only split further while their
+// cache miss ratio stays within threshold times that of the input, bounding how much cache efficiency can be lost.
+void OptimizeOverdraw(std::span<uint32_t> indices,
+                      const float* positions,
+                      size_t vertexCount,
+                      size_t positionStride,
+                      float threshold = 1.05f);
+
+// Measure vertex fetch efficiency for a triangle list drawing vertices of the given size.
+VertexFetchStats AnalyzeVertexFetch(std::span<const uint32_t> indices, size_t vertexCount, size_t vertexSize);
+
+// Reorder vertices into the order they are first used by the index buffer and rewrite the indices to match, so that
+// vertex fetch walks through memory linearly. Vertices which are never used are moved to the end.
+void OptimizeVertexFetch(std::span<uint32_t> indices, void* vertices, size_t vertexCount, size_t vertexSize);
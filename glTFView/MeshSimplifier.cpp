@@ -0,0 +1,300 @@
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// The sum of the squared distances to a set of planes, each weighted by the area of the triangle it came from. Kept in
+// doubles, as the terms cancel each other out heavily when evaluated near the planes.
+struct Quadric {
+	double A00 = 0.0, A11 = 0.0, A22 = 0.0, A01 = 0.0, A02 = 0.0, A12 = 0.0;
+	double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+	double C      = 0.0;
+	double Weight = 0.0;
+
+	Quadric& operator+=(const Quadric& other) {
+		A00 += other.A00;
+		A11 += other.A11;
+		A22 += other.A22;
+		A01 += other.A01;
+		A02 += other.A02;
+		A12 += other.A12;
+		B0 += other.B0;
+		B1 += other.B1;
+		B2 += other.B2;
+		C += other.C;
+		Weight += other.Weight;
+		return *this;
+	}
+
+	// The weighted mean squared distance from a point to the planes.
+	double Error(const glm::vec3& p) const {
+		if (Weight <= 0.0) { return 0.0; }
+
+		const double x = p.x, y = p.y, z = p.z;
+		const double error = A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) +
+		                     2.0 * (B0 * x + B1 * y + B2 * z) + C;
+
+		return std::max(error, 0.0) / Weight;
+	}
+};
+
+static Quadric GetPlaneQuadric(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+	const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+	const float length    = glm::length(cross);
+	if (length == 0.0f) { return {}; }
+
+	const glm::dvec3 n = glm::dvec3(cross / length);
+	const double d     = -glm::dot(n, glm::dvec3(p0));
+	const double w     = length * 0.5;
+
+	Quadric q;
+	q.A00    = w * n.x * n.x;
+	q.A11    = w * n.y * n.y;
+	q.A22    = w * n.z * n.z;
+	q.A01    = w * n.x * n.y;
+	q.A02    = w * n.x * n.z;
+	q.A12    = w * n.y * n.z;
+	q.B0     = w * n.x * d;
+	q.B1     = w * n.y * d;
+	q.B2     = w * n.z * d;
+	q.C      = w * d * d;
+	q.Weight = w;
+
+	return q;
+}
+
+struct Collapse {
+	uint32_t From = 0;
+	uint32_t To   = 0;
+	double Error  = 0.0;
+};
+
+size_t SimplifyMesh(std::span<uint32_t> destination,
+                    std::span<const uint32_t> indices,
+                    const float* positions,
+                    size_t vertexCount,
+                    size_t positionStride,
+                    size_t targetIndexCount,
+                    float targetError,
+                    float* resultError) {
+	std::copy(indices.begin(), indices.end(), destination.begin());
+	size_t indexCount = indices.size() / 3 * 3;
+	if (resultError) { *resultError = 0.0f; }
+	if (indexCount <= targetIndexCount || vertexCount == 0) { return indexCount; }
+
+	// Work in a space where the mesh's bounds have a diagonal of 1, so that errors come out relative to its size.
+	std::vector<glm::vec3> vertexPositions(vertexCount);
+	glm::vec3 boundsMin(std::numeric_limits<float>::max());
+	glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+	for (size_t i = 0; i < indexCount; ++i) {
+		const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) +
+		                                                indices[i] * positionStride);
+		vertexPositions[indices[i]] = glm::vec3(p[0], p[1], p[2]);
+		boundsMin                   = glm::min(boundsMin, vertexPositions[indices[i]]);
+		boundsMax                   = glm::max(boundsMax, vertexPositions[indices[i]]);
+	}
+	const float diagonal = glm::length(boundsMax - boundsMin);
+	if (diagonal == 0.0f) { return indexCount; }
+	for (auto& p : vertexPositions) { p = (p - boundsMin) / diagonal; }
+
+	// Group the vertices which share a position. Several vertices at one position are wedges of a seam between
+	// different normals or texture coordinates. Topology and error are worked out per position, through the canonical
+	// (first) wedge of each, so that seams are neither mistaken for open borders nor torn open by a collapse. The wedges
+	// of a position form a ring through nextWedge.
+	std::vector<uint32_t> canonical(vertexCount);
+	std::vector<uint32_t> nextWedge(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; ++v) {
+		canonical[v] = v;
+		nextWedge[v] = v;
+	}
+	{
+		std::vector<bool> used(vertexCount, false);
+		for (size_t i = 0; i < indexCount; ++i) { used[indices[i]] = true; }
+		std::vector<uint32_t> order;
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			if (used[v]) { order.push_back(v); }
+		}
+		auto PositionLess = [&vertexPositions](uint32_t a, uint32_t b) {
+			const glm::vec3& pa = vertexPositions[a];
+			const glm::vec3& pb = vertexPositions[b];
+			if (pa.x != pb.x) { return pa.x < pb.x; }
+			if (pa.y != pb.y) { return pa.y < pb.y; }
+			return pa.z < pb.z;
+		};
+		std::sort(order.begin(), order.end(), PositionLess);
+		for (size_t i = 1; i < order.size(); ++i) {
+			const uint32_t previous = order[i - 1];
+			const uint32_t v        = order[i];
+			if (vertexPositions[previous] != vertexPositions[v]) { continue; }
+
+			canonical[v]        = canonical[previous];
+			nextWedge[v]        = nextWedge[previous];
+			nextWedge[previous] = v;
+		}
+	}
+
+	// Lock the ends of every edge which is not shared by exactly one other triangle running the opposite way. These are
+	// open borders, or places where the mesh is not manifold, and collapsing them would eat into the mesh's outline.
+	// Edges are compared by position, so the two sides of a seam count as the same edge.
+	std::vector<bool> locked(vertexCount, false);
+	{
+		std::vector<uint64_t> edges;
+		edges.reserve(indexCount);
+		for (size_t t = 0; t < indexCount; t += 3) {
+			for (size_t k = 0; k < 3; ++k) {
+				const uint64_t a = canonical[destination[t + k]];
+				const uint64_t b = canonical[destination[t + (k + 1) % 3]];
+				edges.push_back((a << 32) | b);
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+		for (size_t i = 0; i < edges.size(); ++i) {
+			const uint32_t a        = static_cast<uint32_t>(edges[i] >> 32);
+			const uint32_t b        = static_cast<uint32_t>(edges[i]);
+			const uint64_t opposite = (uint64_t(b) << 32) | a;
+			const bool duplicate =
+				(i > 0 && edges[i - 1] == edges[i]) || (i + 1 < edges.size() && edges[i + 1] == edges[i]);
+			const auto range        = std::equal_range(edges.begin(), edges.end(), opposite);
+			if (duplicate || range.second - range.first != 1) {
+				locked[a] = true;
+				locked[b] = true;
+			}
+		}
+	}
+
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t t = 0; t < indexCount; t += 3) {
+		const Quadric q = GetPlaneQuadric(vertexPositions[destination[t + 0]],
+		                                  vertexPositions[destination[t + 1]],
+		                                  vertexPositions[destination[t + 2]]);
+		for (size_t k = 0; k < 3; ++k) { quadrics[canonical[destination[t + k]]] += q; }
+	}
+
+	const double maxError = double(targetError) * double(targetError);
+	double worstError     = 0.0;
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<bool> touched(vertexCount);
+	std::vector<std::pair<uint32_t, uint32_t>> wedgeTargets;
+
+	// Collapses are made in passes. Each pass considers every edge, then makes the cheapest collapses it can without two
+	// of them touching the same triangles, so that each collapse can be checked against the mesh as it stands. Collapses
+	// are between positions: every wedge of one moves onto the wedge of the other it shares a triangle with, so a seam
+	// is only ever collapsed along itself, with both of its sides together.
+	while (indexCount > targetIndexCount) {
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (size_t i = 0; i < indexCount; ++i) { adjacencyOffsets[destination[i] + 1]++; }
+		for (size_t v = 0; v < vertexCount; ++v) { adjacencyOffsets[v + 1] += adjacencyOffsets[v]; }
+		adjacency.resize(indexCount);
+		{
+			std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < indexCount; ++i) { adjacency[fill[destination[i]]++] = static_cast<uint32_t>(i / 3); }
+		}
+
+		collapses.clear();
+		for (size_t t = 0; t < indexCount; t += 3) {
+			for (size_t k = 0; k < 3; ++k) {
+				const uint32_t a = canonical[destination[t + k]];
+				const uint32_t b = canonical[destination[t + (k + 1) % 3]];
+				if (!locked[a]) { collapses.push_back({a, b, quadrics[a].Error(vertexPositions[b])}); }
+				if (!locked[b]) { collapses.push_back({b, a, quadrics[b].Error(vertexPositions[a])}); }
+			}
+		}
+		auto ErrorLess = [](const Collapse& a, const Collapse& b) { return a.Error < b.Error; };
+		std::sort(collapses.begin(), collapses.end(), ErrorLess);
+
+		for (uint32_t v = 0; v < vertexCount; ++v) { remap[v] = v; }
+		std::fill(touched.begin(), touched.end(), false);
+
+		const size_t trianglesToRemove = (indexCount - targetIndexCount + 2) / 3;
+		size_t trianglesRemoved        = 0;
+		size_t collapseCount           = 0;
+		for (const auto& collapse : collapses) {
+			if (collapse.Error > maxError || trianglesRemoved >= trianglesToRemove) { break; }
+			if (touched[collapse.From] || touched[collapse.To]) { continue; }
+
+			// Every wedge of From must share a triangle with exactly one wedge of To, which it moves onto. A wedge with
+			// none would be pulled across a seam, and one with several sits where the seam splits.
+			wedgeTargets.clear();
+			bool valid     = true;
+			uint32_t wedge = collapse.From;
+			do {
+				uint32_t match = ~0u;
+				for (uint32_t a = adjacencyOffsets[wedge]; a < adjacencyOffsets[wedge + 1] && valid; ++a) {
+					const uint32_t* triangle = &destination[adjacency[a] * 3];
+					for (size_t k = 0; k < 3; ++k) {
+						if (canonical[triangle[k]] != collapse.To) { continue; }
+						if (match != ~0u && match != triangle[k]) { valid = false; }
+						match = triangle[k];
+					}
+				}
+				valid = valid && match != ~0u;
+				wedgeTargets.push_back({wedge, match});
+				wedge = nextWedge[wedge];
+			} while (valid && wedge != collapse.From);
+			if (!valid) { continue; }
+
+			// Moving From onto To must not turn any of the triangles around From over.
+			const glm::vec3& target = vertexPositions[collapse.To];
+			bool flips              = false;
+			size_t removed          = 0;
+			for (const auto& [from, to] : wedgeTargets) {
+				for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1] && !flips; ++a) {
+					const uint32_t* triangle = &destination[adjacency[a] * 3];
+					if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+						++removed;
+						continue;
+					}
+
+					glm::vec3 p[3];
+					for (size_t k = 0; k < 3; ++k) { p[k] = vertexPositions[triangle[k]]; }
+					const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+					for (size_t k = 0; k < 3; ++k) {
+						if (triangle[k] == from) { p[k] = target; }
+					}
+					const glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+					flips                 = glm::dot(before, after) <= 0.0f;
+				}
+			}
+			if (flips) { continue; }
+
+			quadrics[collapse.To] += quadrics[collapse.From];
+			for (const auto& [from, to] : wedgeTargets) {
+				remap[from] = to;
+				for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a) {
+					const uint32_t* triangle = &destination[adjacency[a] * 3];
+					for (size_t k = 0; k < 3; ++k) { touched[canonical[triangle[k]]] = true; }
+				}
+			}
+			trianglesRemoved += removed;
+			worstError = std::max(worstError, collapse.Error);
+			++collapseCount;
+		}
+		if (collapseCount == 0) { break; }
+
+		// Apply the collapses, dropping every triangle which has become degenerate.
+		size_t writeIndex = 0;
+		for (size_t t = 0; t < indexCount; t += 3) {
+			const uint32_t a = remap[destination[t + 0]];
+			const uint32_t b = remap[destination[t + 1]];
+			const uint32_t c = remap[destination[t + 2]];
+			if (a == b || b == c || c == a) { continue; }
+
+			destination[writeIndex++] = a;
+			destination[writeIndex++] = b;
+			destination[writeIndex++] = c;
+		}
+		indexCount = writeIndex;
+	}
+
+	if (resultError) { *resultError = static_cast<float>(std::sqrt(worstError)); }
+
+	return indexCount;
+}
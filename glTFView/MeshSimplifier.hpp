@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Simplify a triangle list by collapsing edges, cheapest first, as measured by the quadric error metric of Garland and
+// Heckbert's "Surface Simplification Using Quadric Error Metrics". Vertices are only ever collapsed onto one another,
+// never moved, so the result draws from the same vertex buffer as the input and can be used as a level of detail.
+// Vertices on open borders are never removed, keeping the outline of the mesh intact. Vertices which share a position
+// (the wedges of a seam between different normals or texture coordinates) are collapsed together, and only along the
+// seam, so that it is never torn open and the texture mapping on either side survives.
+//
+// Simplification stops once the index count is at or below targetIndexCount, or once any further collapse would move
+// the surface by more than targetError. Errors are relative to the diagonal of the mesh's bounds, and the largest error
+// of any collapse made is written to resultError. destination must hold as many indices as the input, and the number of
+// indices written is returned. Positions are three floats, positionStride bytes apart.
+size_t SimplifyMesh(std::span<uint32_t> destination,
+                    std::span<const uint32_t> indices,
+                    const float* positions,
+                    size_t vertexCount,
+                    size_t positionStride,
+                    size_t targetIndexCount,
+                    float targetError,
+                    float* resultError = nullptr);
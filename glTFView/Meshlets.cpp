@@ -0,0 +1,251 @@
+#include "Meshlets.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+// Meshlets whose triangle normals spread further than this from their average are never considered backfacing, as
+// their cone would be too wide to ever cull anything.
+static constexpr float MinConeDot = 0.1f;
+
+static glm::vec3 GetPosition(const float* positions, size_t positionStride, uint32_t index) {
+	const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + index * positionStride);
+	return glm::vec3(p[0], p[1], p[2]);
+}
+
+// Fill in the bounding sphere and normal cone of a meshlet from its triangles.
+static void ComputeMeshletBounds(Meshlet& meshlet,
+                                 std::span<const uint32_t> indices,
+                                 const float* positions,
+                                 size_t positionStride) {
+	const size_t triangleCount = indices.size() / 3;
+
+	glm::vec3 boundsMin(std::numeric_limits<float>::max());
+	glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+	for (const auto index : indices) {
+		const glm::vec3 p = GetPosition(positions, positionStride, index);
+		boundsMin         = glm::min(boundsMin, p);
+		boundsMax         = glm::max(boundsMax, p);
+	}
+	meshlet.Center = (boundsMin + boundsMax) * 0.5f;
+	meshlet.Radius = 0.0f;
+	for (const auto index : indices) {
+		const glm::vec3 offset = GetPosition(positions, positionStride, index) - meshlet.Center;
+		meshlet.Radius         = std::max(meshlet.Radius, glm::length(offset));
+	}
+
+	// The cone axis is the average of the triangle normals, and its angle is that of the normal furthest from the axis.
+	std::vector<glm::vec3> normals;
+	normals.reserve(triangleCount);
+	glm::vec3 normalSum(0.0f);
+	for (size_t t = 0; t < triangleCount; ++t) {
+		const glm::vec3 p0 = GetPosition(positions, positionStride, indices[t * 3 + 0]);
+		const glm::vec3 p1 = GetPosition(positions, positionStride, indices[t * 3 + 1]);
+		const glm::vec3 p2 = GetPosition(positions, positionStride, indices[t * 3 + 2]);
+		const glm::vec3 n  = glm::cross(p1 - p0, p2 - p0);
+		const float length = glm::length(n);
+		if (length == 0.0f) {
+			normals.push_back(glm::vec3(0.0f));
+			continue;
+		}
+		normals.push_back(n / length);
+		normalSum += normals.back();
+	}
+
+	meshlet.ConeApex   = meshlet.Center;
+	meshlet.ConeAxis   = glm::vec3(0.0f);
+	meshlet.ConeCutoff = 1.0f;
+
+	const float sumLength = glm::length(normalSum);
+	if (sumLength == 0.0f) { return; }
+	const glm::vec3 axis = normalSum / sumLength;
+
+	float minDot = 1.0f;
+	for (const auto& n : normals) {
+		if (n != glm::vec3(0.0f)) { minDot = std::min(minDot, glm::dot(axis, n)); }
+	}
+	if (minDot <= MinConeDot) { return; }
+
+	// Move the apex back along the axis until it is behind every triangle's plane, so the cone contains them all.
+	float maxT = 0.0f;
+	for (size_t t = 0; t < triangleCount; ++t) {
+		if (normals[t] == glm::vec3(0.0f)) { continue; }
+		const glm::vec3 p0 = GetPosition(positions, positionStride, indices[t * 3 + 0]);
+		const float dc     = glm::dot(meshlet.Center - p0, normals[t]);
+		const float dn     = glm::dot(axis, normals[t]);
+		maxT               = std::max(maxT, dc / dn);
+	}
+
+	meshlet.ConeApex   = meshlet.Center - axis * maxT;
+	meshlet.ConeAxis   = axis;
+	meshlet.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+std::vector<Meshlet> BuildMeshlets(std::span<uint32_t> indices,
+                                   const float* positions,
+                                   size_t vertexCount,
+                                   size_t positionStride,
+                                   uint32_t maxVertices,
+                                   uint32_t maxTriangles) {
+	std::vector<Meshlet> meshlets;
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) { return meshlets; }
+
+	// Find the triangles using each vertex.
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; ++i) { adjacencyOffsets[indices[i] + 1]++; }
+	for (size_t v = 0; v < vertexCount; ++v) { adjacencyOffsets[v + 1] += adjacencyOffsets[v]; }
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; ++i) { adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3); }
+	}
+
+	std::vector<glm::vec3> triangleCenters(triangleCount);
+	for (size_t t = 0; t < triangleCount; ++t) {
+		triangleCenters[t] = (GetPosition(positions, positionStride, indices[t * 3 + 0]) +
+		                      GetPosition(positions, positionStride, indices[t * 3 + 1]) +
+		                      GetPosition(positions, positionStride, indices[t * 3 + 2])) /
+		                     3.0f;
+	}
+
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	std::vector<bool> emitted(triangleCount, false);
+	// The meshlet each vertex was last added to.
+	std::vector<uint32_t> vertexMeshlet(vertexCount, InvalidIndex);
+	std::vector<uint32_t> meshletVertices;
+	meshletVertices.reserve(maxVertices);
+
+	uint32_t meshletIndex      = 0;
+	uint32_t meshletTriangles  = 0;
+	uint32_t lastTriangle      = InvalidIndex;
+	size_t meshletFirstIndex   = 0;
+	size_t nextUnusedTriangle  = 0;
+	glm::vec3 meshletCenterSum = glm::vec3(0.0f);
+
+	auto NewVertices = [&](uint32_t t) {
+		uint32_t count = 0;
+		for (size_t k = 0; k < 3; ++k) {
+			if (vertexMeshlet[indices[t * 3 + k]] != meshletIndex) { ++count; }
+		}
+		return count;
+	};
+
+	// Find the best triangle to add next among those using the given vertices: the one adding the fewest new vertices,
+	// then the one closest to the meshlet's center.
+	auto FindCandidate = [&](std::span<const uint32_t> vertices) {
+		const glm::vec3 center = meshletCenterSum / float(meshletTriangles);
+		uint32_t best          = InvalidIndex;
+		uint32_t bestNew       = 0;
+		float bestDistance     = 0.0f;
+		for (const auto v : vertices) {
+			for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; ++a) {
+				const uint32_t t = adjacency[a];
+				if (emitted[t]) { continue; }
+
+				const uint32_t newVertices = NewVertices(t);
+				if (meshletVertices.size() + newVertices > maxVertices) { continue; }
+
+				const glm::vec3 offset = triangleCenters[t] - center;
+				const float distance   = glm::dot(offset, offset);
+				if (best == InvalidIndex || newVertices < bestNew || (newVertices == bestNew && distance < bestDistance)) {
+					best         = t;
+					bestNew      = newVertices;
+					bestDistance = distance;
+				}
+			}
+		}
+
+		return best;
+	};
+
+	auto FinishMeshlet = [&]() {
+		Meshlet meshlet;
+		meshlet.FirstIndex  = static_cast<uint32_t>(meshletFirstIndex);
+		meshlet.IndexCount  = static_cast<uint32_t>(output.size() - meshletFirstIndex);
+		meshlet.VertexCount = static_cast<uint32_t>(meshletVertices.size());
+		ComputeMeshletBounds(meshlet,
+		                     std::span<const uint32_t>(output.data() + meshletFirstIndex, meshlet.IndexCount),
+		                     positions,
+		                     positionStride);
+		meshlets.push_back(meshlet);
+
+		++meshletIndex;
+		meshletTriangles  = 0;
+		lastTriangle      = InvalidIndex;
+		meshletFirstIndex = output.size();
+		meshletCenterSum  = glm::vec3(0.0f);
+		meshletVertices.clear();
+	};
+
+	while (true) {
+		uint32_t next = InvalidIndex;
+		if (meshletTriangles > 0) {
+			// Prefer the neighbours of the triangle just added, and only look at the whole meshlet when there are none.
+			const uint32_t lastVertices[3] = {
+				indices[lastTriangle * 3 + 0], indices[lastTriangle * 3 + 1], indices[lastTriangle * 3 + 2]};
+			next = FindCandidate(lastVertices);
+			if (next == InvalidIndex) { next = FindCandidate(meshletVertices); }
+			if (next == InvalidIndex) {
+				FinishMeshlet();
+				continue;
+			}
+		} else {
+			while (nextUnusedTriangle < triangleCount && emitted[nextUnusedTriangle]) { ++nextUnusedTriangle; }
+			if (nextUnusedTriangle == triangleCount) { break; }
+			next = static_cast<uint32_t>(nextUnusedTriangle);
+		}
+
+		for (size_t k = 0; k < 3; ++k) {
+			const uint32_t v = indices[next * 3 + k];
+			if (vertexMeshlet[v] != meshletIndex) {
+				vertexMeshlet[v] = meshletIndex;
+				meshletVertices.push_back(v);
+			}
+			output.push_back(v);
+		}
+		emitted[next] = true;
+		lastTriangle  = next;
+		meshletCenterSum += triangleCenters[next];
+		if (++meshletTriangles == maxTriangles) { FinishMeshlet(); }
+	}
+	if (meshletTriangles > 0) { FinishMeshlet(); }
+
+	std::copy(output.begin(), output.end(), indices.begin());
+
+	return meshlets;
+}
+
+Frustum::Frustum(const glm::mat4& matrix) {
+	const glm::vec4 row0(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+	const glm::vec4 row1(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+	const glm::vec4 row2(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+	const glm::vec4 row3(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+
+	Planes[0] = row3 + row0;  // Left
+	Planes[1] = row3 - row0;  // Right
+	Planes[2] = row3 + row1;  // Bottom
+	Planes[3] = row3 - row1;  // Top
+	Planes[4] = row2;         // Near
+	Planes[5] = row3 - row2;  // Far
+}
+
+bool Frustum::Intersects(const glm::vec3& center, float radius) const {
+	for (const auto& plane : Planes) {
+		const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+		if (distance < -radius * glm::length(glm::vec3(plane))) { return false; }
+	}
+
+	return true;
+}
+
+bool IsMeshletBackfacing(const Meshlet& meshlet, const glm::vec3& viewer) {
+	const glm::vec3 toApex = meshlet.ConeApex - viewer;
+	const float distance   = glm::length(toApex);
+	if (distance == 0.0f) { return false; }
+
+	return glm::dot(toApex, meshlet.ConeAxis) >= meshlet.ConeCutoff * distance;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+// The size limits for a meshlet. These match what mesh shading hardware handles well per workgroup, and keep each
+// meshlet small enough for culling to be worthwhile.
+constexpr uint32_t MeshletMaxVertices  = 64;
+constexpr uint32_t MeshletMaxTriangles = 124;
+
+// A small cluster of a submesh's triangles, with the bounds needed to cull it as a whole. The triangles of a meshlet
+// are contiguous in the index buffer, so visible meshlets can be drawn with ordinary indexed draws, and a run of
+// consecutive visible meshlets with a single draw.
+//
+// Laid out to match std430, so that the meshlets stored in a mesh's buffer can be read as-is by a compute shader.
+struct Meshlet {
+	// Bounding sphere.
+	glm::vec3 Center = glm::vec3(0.0f);
+	float Radius     = 0.0f;
+	// Normal cone. Every triangle in the meshlet faces away from any viewer for which
+	// dot(normalize(ConeApex - viewer), ConeAxis) >= ConeCutoff. Meshlets whose triangles face too many different ways
+	// have a cutoff of 1 and a zero axis, so that they are never culled.
+	glm::vec3 ConeApex = glm::vec3(0.0f);
+	float ConeCutoff   = 1.0f;
+	glm::vec3 ConeAxis = glm::vec3(0.0f);
+	// Relative to the first index of the submesh.
+	uint32_t FirstIndex  = 0;
+	uint32_t IndexCount  = 0;
+	uint32_t VertexCount = 0;
+	uint32_t Padding[2]  = {};
+};
+static_assert(sizeof(Meshlet) == 64);
+
+// Statistics from splitting submeshes into meshlets.
+struct MeshletStats {
+	size_t Meshlets  = 0;
+	size_t Vertices  = 0;
+	size_t Triangles = 0;
+
+	double AverageVertices() const {
+		return Meshlets ? double(Vertices) / double(Meshlets) : 0.0;
+	}
+	double AverageTriangles() const {
+		return Meshlets ? double(Triangles) / double(Meshlets) : 0.0;
+	}
+
+	MeshletStats& operator+=(const MeshletStats& other) {
+		Meshlets += other.Meshlets;
+		Vertices += other.Vertices;
+		Triangles += other.Triangles;
+		return *this;
+	}
+};
+
+// Split a triangle list into meshlets, reordering its triangles so that those of each meshlet are contiguous. Meshlets
+// are grown from triangles which share vertices with what is already in them, keeping each one spatially compact, and
+// are started in the order the triangles were given in, so the result largely keeps the order of the input. Positions
+// are three floats, positionStride bytes apart.
+std::vector<Meshlet> BuildMeshlets(std::span<uint32_t> indices,
+                                   const float* positions,
+                                   size_t vertexCount,
+                                   size_t positionStride,
+                                   uint32_t maxVertices  = MeshletMaxVertices,
+                                   uint32_t maxTriangles = MeshletMaxTriangles);
+
+// A view frustum as six planes facing inward, in whichever space the matrix it was extracted from maps from.
+struct Frustum {
+	Frustum() = default;
+	// Extract the planes of a projection (or model-view-projection) matrix, with a 0 to 1 depth range.
+	explicit Frustum(const glm::mat4& matrix);
+
+	// Test a bounding sphere. Planes are not normalized, so spheres can be tested in the space of a model matrix
+	// folded into the frustum, including one with non-uniform scale.
+	bool Intersects(const glm::vec3& center, float radius) const;
+
+	std::array<glm::vec4, 6> Planes;
+};
+
+// Whether every triangle of a meshlet faces away from a viewer at the given position, in the meshlet's space.
+bool IsMeshletBackfacing(const Meshlet& meshlet, const glm::vec3& viewer);
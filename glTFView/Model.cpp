@@ -15,12 +15,67 @@
 #include <glm/gtx/normal.hpp>
 #include <iostream>
 #include <optional>
+#include <sstream>
+#include <unordered_map>
 
+#include "AccessorKernels.hpp"
 #include "Files.hpp"
+#include "GeometryCache.hpp"
+#include "ImageCache.hpp"
+#include "Ktx2.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "Meshlets.hpp"
+#include "TextureCache.hpp"
+#include "TextureCompression.hpp"
+#include "ThreadPool.hpp"
+#include "VertexPacking.hpp"
+#include "VertexWelder.hpp"
 #include "mikktspace.h"
 
-static constexpr bool ApplyTransforms = true;
-static constexpr bool MergeSubmeshes  = true;
+static constexpr bool ApplyTransforms  = true;
+static constexpr bool MergeSubmeshes   = true;
+static constexpr bool UseGeometryCache = true;
+// Reorder each submesh's triangles for the GPU's post-transform vertex cache.
+static constexpr bool VertexCacheOrder = true;
+// Sort clusters of each submesh's triangles to reduce overdraw, at a small cost to vertex cache efficiency.
+static constexpr bool OverdrawOrder = true;
+// Split each submesh into meshlets which can be culled individually.
+static constexpr bool GenerateMeshlets = true;
+// Generate simplified levels of detail for each submesh, so that distant objects can be drawn with fewer triangles.
+static constexpr bool GenerateLods = true;
+// Each level of detail aims for this fraction of the triangles of the level before it.
+static constexpr float LodReduction = 0.5f;
+// A level is only kept if it has at most this fraction of the triangles of the level before it. Simplification stalls
+// once the remaining triangles are all needed to keep the error down, and levels past that point would cost memory
+// while saving next to nothing.
+static constexpr float LodMinReduction = 0.85f;
+// The largest error a level of detail may have, relative to the size of its submesh.
+static constexpr float LodMaxError = 0.05f;
+// Submeshes with fewer triangles than this are cheap enough to never need simplifying.
+static constexpr size_t LodMinTriangles = 64;
+// Reorder each submesh's vertices into the order they are first used, so vertex fetch walks memory linearly.
+static constexpr bool VertexFetchOrder = true;
+// Store each vertex input in its own stream rather than interleaving them, so passes which only need positions can
+// skip fetching everything else.
+static constexpr bool DeinterleaveVertices = true;
+// Use 16-bit indices for meshes whose submeshes are all small enough. Indices are relative to the first vertex of their
+// submesh, so this only depends on the size of each submesh, not of the whole mesh.
+static constexpr bool ShortIndices = true;
+// The largest submesh which can use 16-bit indices. 0xffff itself is left free, as it is the primitive restart index.
+static constexpr size_t MaxShortIndexVertices = 0xffff;
+// Meshlets are stored after a mesh's indices, aligned so that they can be bound as a storage buffer.
+static constexpr size_t MeshletAlignment = 256;
+// Vertex positions are snapped to a grid of this size before welding, so that nearly identical vertices are merged.
+// Zero only welds exact duplicates.
+static constexpr float WeldTolerance = 0.0f;
+// Block compress images which are not already compressed, with full mip chains, caching the results on disk.
+static constexpr bool CompressTextures = true;
+// Drop animation keys which interpolating between the keys around them reproduces to within a tolerance. Rotations are
+// compared by quaternion component, and translations and scales relative to the range their track covers.
+static constexpr bool ReduceAnimationKeys   = true;
+static constexpr float RotationKeyTolerance = 1e-4f;
+static constexpr float VectorKeyTolerance   = 1e-4f;
 
 namespace fastgltf {
 std::string to_string(AccessorType type) {
@@ -142,7 +197,12 @@ enum class MeshProcessingStepBits {
 	UnpackVertices       = 1 << 1,
 	GenerateFlatNormals  = 1 << 2,
 	GenerateTangentSpace = 1 << 3,
-	WeldVertices         = 1 << 4
+	WeldVertices         = 1 << 4,
+	OptimizeVertexCache  = 1 << 5,
+	OptimizeOverdraw     = 1 << 6,
+	OptimizeVertexFetch  = 1 << 7,
+	BuildMeshlets        = 1 << 8,
+	GenerateLods         = 1 << 9
 };
 using MeshProcessingSteps = tk::Bitmask<MeshProcessingStepBits>;
 template <>
@@ -176,7 +236,7 @@ void Material::Update(tk::Device& device) const {
 	Data.OcclusionFactor = OcclusionFactor;
 
 	const auto dataHash = tk::Hasher(Data).Get();
-	const bool update   = dataHash != DataHash || !DataBuffer;
+	const bool update   = UploadData && (dataHash != DataHash || !DataBuffer);
 	if (update) {
 		if (!DataBuffer) {
 			DataBuffer = device.CreateBuffer(
@@ -189,6 +249,46 @@ void Material::Update(tk::Device& device) const {
 	DataHash = dataHash;
 }
 
+KeyframeBlend Animation::GetBlend(const AnimationChannel& channel,
+                                  float time,
+                                  KeyframeCursor& cursor,
+                                  glm::vec4* keys) const {
+	const auto& sampler = Samplers[channel.Sampler];
+	const auto& times   = TimeTracks[sampler.Times];
+	const auto key      = FindKeyframe(times, time, cursor);
+	const size_t i      = key.Index;
+	const size_t next   = std::min(i + 1, times.size() - 1);
+
+	switch (sampler.Interpolation) {
+		// Times past the last key come back as the end of the last interval, which a step holds the last key for.
+		case AnimationInterpolation::Step:
+			keys[0] = sampler.Keys.Decode(key.Factor < 1.0f ? i : next);
+			return StepBlend(glm::value_ptr(keys[0]));
+
+		case AnimationInterpolation::CubicSpline:
+			if (next == i) {
+				keys[0] = sampler.Keys.Decode(i * 3 + 1);
+				return StepBlend(glm::value_ptr(keys[0]));
+			}
+			for (size_t k = 0; k < 4; ++k) { keys[k] = sampler.Keys.Decode(i * 3 + 1 + k); }
+			return HermiteBlend(glm::value_ptr(keys[0]), key.Factor, times[next] - times[i]);
+
+		case AnimationInterpolation::Linear:
+		default:
+			keys[0] = sampler.Keys.Decode(i);
+			keys[1] = sampler.Keys.Decode(next);
+			if (channel.Path == AnimationPath::Rotation) {
+				return SlerpBlend(glm::value_ptr(keys[0]), glm::value_ptr(keys[1]), key.Factor);
+			}
+			return LerpBlend(glm::value_ptr(keys[0]), glm::value_ptr(keys[1]), key.Factor);
+	}
+}
+
+bool Animation::IsPlayable(const AnimationChannel& channel) const {
+	return channel.Target && channel.Path != AnimationPath::Weights &&
+	       !TimeTracks[Samplers[channel.Sampler].Times].empty();
+}
+
 struct MikkTContext {
 	std::vector<Vertex>& Vertices;
 	Material* Material = nullptr;
@@ -242,12 +342,23 @@ static SMikkTSpaceInterface MikkTInterface = {.m_getNumFaces          = MikkTGet
 /* ========================
 ** === Helper Functions ===
    ======================== */
+// The raw bytes of every glTF buffer, indexed the same as the asset's buffers.
+using BufferData = std::vector<std::span<const uint8_t>>;
+
+static const uint8_t* GetAccessorBytes(const fastgltf::Asset& gltfModel,
+                                       const BufferData& buffers,
+                                       const fastgltf::Accessor& gltfAccessor) {
+	const auto& gltfBufferView = gltfModel.bufferViews[gltfAccessor.bufferViewIndex.value()];
+
+	return buffers[gltfBufferView.bufferIndex].data() + gltfBufferView.byteOffset + gltfAccessor.byteOffset;
+}
 template <typename T>
 static vk::DeviceSize GetAlignedSize(vk::DeviceSize count) {
 	return ((count * sizeof(T)) + 16llu) & ~16llu;
 }
 static std::unique_ptr<fastgltf::Asset> ParseGltf(const std::filesystem::path& gltfPath) {
-	fastgltf::Parser parser(fastgltf::Extensions::KHR_mesh_quantization | fastgltf::Extensions::KHR_texture_transform);
+	fastgltf::Parser parser(fastgltf::Extensions::KHR_mesh_quantization | fastgltf::Extensions::KHR_texture_transform |
+	                        fastgltf::Extensions::KHR_texture_basisu);
 
 	const auto gltfFile = gltfPath.string();
 	const auto gltfExt  = gltfPath.extension().string();
@@ -286,42 +397,217 @@ static std::unique_ptr<fastgltf::Asset> ParseGltf(const std::filesystem::path& g
 
 	return loaded->getParsedAsset();
 }
+// The Srgb or Unorm counterpart of a format, for pre-compressed textures whose color space disagrees with how the
+// material uses them. Formats without a counterpart are returned unchanged.
+static vk::Format MatchColorSpace(vk::Format format, bool srgb) {
+	static constexpr std::pair<vk::Format, vk::Format> Counterparts[] = {
+		{vk::Format::eR8Unorm, vk::Format::eR8Srgb},
+		{vk::Format::eR8G8Unorm, vk::Format::eR8G8Srgb},
+		{vk::Format::eR8G8B8A8Unorm, vk::Format::eR8G8B8A8Srgb},
+		{vk::Format::eB8G8R8A8Unorm, vk::Format::eB8G8R8A8Srgb},
+		{vk::Format::eBc1RgbUnormBlock, vk::Format::eBc1RgbSrgbBlock},
+		{vk::Format::eBc1RgbaUnormBlock, vk::Format::eBc1RgbaSrgbBlock},
+		{vk::Format::eBc2UnormBlock, vk::Format::eBc2SrgbBlock},
+		{vk::Format::eBc3UnormBlock, vk::Format::eBc3SrgbBlock},
+		{vk::Format::eBc7UnormBlock, vk::Format::eBc7SrgbBlock},
+		{vk::Format::eEtc2R8G8B8UnormBlock, vk::Format::eEtc2R8G8B8SrgbBlock},
+		{vk::Format::eEtc2R8G8B8A1UnormBlock, vk::Format::eEtc2R8G8B8A1SrgbBlock},
+		{vk::Format::eEtc2R8G8B8A8UnormBlock, vk::Format::eEtc2R8G8B8A8SrgbBlock},
+	};
+	for (const auto& [unormFormat, srgbFormat] : Counterparts) {
+		if (format == unormFormat || format == srgbFormat) { return srgb ? srgbFormat : unormFormat; }
+	}
+
+	return format;
+}
+
+// The ways materials can use an image. An image's usage is combined from every material which references it.
+enum TextureUsage : uint32_t {
+	TextureUsageBaseColor         = 1 << 0,
+	TextureUsageMetallicRoughness = 1 << 1,
+	TextureUsageNormal            = 1 << 2,
+	TextureUsageOcclusion         = 1 << 3,
+	TextureUsageEmissive          = 1 << 4,
+};
+
+// The block compressed format an image is best stored in, given how it is used. Normal maps only need their X and Y,
+// as the shader rebuilds Z, and occlusion maps only need their red channel.
+static vk::Format ChooseCompressedFormat(uint32_t usage) {
+	if (usage == TextureUsageNormal) { return vk::Format::eBc5UnormBlock; }
+	if (usage == TextureUsageOcclusion) { return vk::Format::eBc4UnormBlock; }
+	if ((usage & ~(TextureUsageMetallicRoughness | TextureUsageOcclusion)) == 0) { return vk::Format::eBc1RgbUnormBlock; }
+
+	return vk::Format::eBc7UnormBlock;
+}
+
+// How an image is stored when it is not block compressed: which of its RGBA channels are kept, the format holding them,
+// and the swizzle which puts them back where the shader reads them.
+struct UncompressedLayout {
+	vk::Format Format     = vk::Format::eR8G8B8A8Unorm;
+	uint32_t ChannelCount = 4;
+	int Channels[4]       = {0, 1, 2, 3};
+	vk::ComponentMapping Swizzle;
+};
+
+// The smallest layout which holds every channel an image's users read. Greyscale color images keep only their grey and
+// alpha channels, as long as the device supports Srgb formats with fewer channels (narrowSrgb).
+static UncompressedLayout ChooseUncompressedLayout(uint32_t usage, int sourceChannels, bool srgb, bool narrowSrgb) {
+	using Swizzle = vk::ComponentSwizzle;
+
+	UncompressedLayout layout;
+	if (usage == TextureUsageOcclusion) {
+		layout = {.Format = vk::Format::eR8Unorm, .ChannelCount = 1, .Channels = {0}};
+	} else if (usage == TextureUsageNormal) {
+		layout = {.Format = vk::Format::eR8G8Unorm, .ChannelCount = 2, .Channels = {0, 1}};
+	} else if (usage == TextureUsageMetallicRoughness) {
+		// Roughness is read from green and metalness from blue.
+		layout = {.Format       = vk::Format::eR8G8Unorm,
+		          .ChannelCount = 2,
+		          .Channels     = {1, 2},
+		          .Swizzle      = {Swizzle::eOne, Swizzle::eR, Swizzle::eG, Swizzle::eOne}};
+	} else if (sourceChannels == 1 && (!srgb || narrowSrgb)) {
+		layout = {.Format       = vk::Format::eR8Unorm,
+		          .ChannelCount = 1,
+		          .Channels     = {0},
+		          .Swizzle      = {Swizzle::eR, Swizzle::eR, Swizzle::eR, Swizzle::eOne}};
+	} else if (sourceChannels == 2 && (!srgb || narrowSrgb)) {
+		layout = {.Format       = vk::Format::eR8G8Unorm,
+		          .ChannelCount = 2,
+		          .Channels     = {0, 3},
+		          .Swizzle      = {Swizzle::eR, Swizzle::eR, Swizzle::eR, Swizzle::eG}};
+	}
+	layout.Format = MatchColorSpace(layout.Format, srgb);
+
+	return layout;
+}
+
+// Where an RGBA channel is found in pixels decoded with their own channel count, or -1 if the image lacks that channel.
+// Greyscale images supply their grey channel for red, green and blue.
+static int GetSourceChannel(int channel, int sourceChannels) {
+	if (sourceChannels >= 3) { return channel < sourceChannels ? channel : -1; }
+	if (channel < 3) { return 0; }
+
+	return sourceChannels == 2 ? 1 : -1;
+}
 
-Model::Model(tk::Device& device, const std::filesystem::path& gltfPath) {
+Model::Model(tk::Device& device,
+             const std::filesystem::path& gltfPath,
+             ModelLoadProgress* progress,
+             const ModelLoadOptions& options)
+		: Model(&device, gltfPath, progress, options) {}
+
+Model::Model(const std::filesystem::path& gltfPath, ModelLoadProgress* progress, const ModelLoadOptions& options)
+		: Model(nullptr, gltfPath, progress, options) {}
+
+Model::Model(tk::Device* device,
+             const std::filesystem::path& gltfPath,
+             ModelLoadProgress* progress,
+             const ModelLoadOptions& options)
+		: _options(options) {
+	if (!device) { _options.UploadData = false; }
 	ProfileTimer loadTimer;
+	auto BeginStep = [progress](uint32_t step, const char* name) {
+		if (progress) { progress->BeginStep(step, name); }
+	};
 
+	BeginStep(0, "Parsing glTF");
 	ProfileTimer parseTimer;
 	auto gltf = ParseGltf(gltfPath);
 	if (!gltf) { throw std::runtime_error("Failed to load glTF file!"); }
 	auto& gltfModel = *gltf;
 	_timeParse      = parseTimer.Get();
+	_gltfDataSize   = std::filesystem::file_size(gltfPath);
 
+	// External buffers are mapped rather than read, so only the pages we actually touch are ever loaded from disk, and
+	// nothing is copied on the way. The mappings stay alive until the model has finished loading.
+	BeginStep(1, "Loading Buffers");
 	ProfileTimer bufferTimer;
-	for (auto& gltfBuffer : gltfModel.buffers) {
+	_buffers.reserve(gltfModel.buffers.size());
+	for (const auto& gltfBuffer : gltfModel.buffers) {
 		if (gltfBuffer.location == fastgltf::DataLocation::FilePathWithByteRange) {
-			const auto bufferPath = gltfBuffer.data.path;
-			gltfBuffer.data.bytes = ReadFileBinary(bufferPath);
+			const auto& bufferFile = _bufferFiles.emplace_back(gltfBuffer.data.path);
+			_buffers.push_back(bufferFile.Bytes());
+		} else {
+			_buffers.push_back(gltfBuffer.data.bytes);
 		}
+		_bufferDataSize += _buffers.back().size();
 	}
 	_timeBufferLoad = bufferTimer.Get();
 
+	// The processed geometry depends on the glTF document itself, every buffer it references, and the options we process
+	// meshes with. Embedded buffers are part of the document, so hashing the document covers them.
+	if (UseGeometryCache) {
+		BeginStep(2, "Hashing Geometry");
+		ProfileTimer hashTimer;
+
+		const MappedFile gltfFile(gltfPath);
+		tk::Hasher h;
+		h(GeometryCache::FileVersion);
+		h(ApplyTransforms);
+		h(MergeSubmeshes);
+		h(WeldTolerance);
+		h(VertexCacheOrder);
+		h(OverdrawOrder);
+		h(GenerateMeshlets);
+		h(GenerateLods);
+		h(LodReduction);
+		h(LodMinReduction);
+		h(LodMaxError);
+		h(LodMinTriangles);
+		h(VertexFetchOrder);
+		h(DeinterleaveVertices);
+		h(ShortIndices);
+		h(GeometryCache::HashContents(gltfFile.Data(), gltfFile.Size()));
+		_geometryHashDataSize += gltfFile.Size();
+		for (size_t i = 0; i < gltfModel.buffers.size(); ++i) {
+			if (gltfModel.buffers[i].location == fastgltf::DataLocation::FilePathWithByteRange) {
+				h(GeometryCache::HashContents(_buffers[i].data(), _buffers[i].size()));
+				_geometryHashDataSize += _buffers[i].size();
+			}
+		}
+		_geometryKey = h.Get();
+
+		_timeGeometryHash = hashTimer.Get();
+	}
+
+	BeginStep(3, "Loading Images");
 	ImportImages(gltfModel, gltfPath, device);
-	ImportSamplers(gltfModel, device);
-	ImportTextures(gltfModel);
-	ImportMaterials(gltfModel);
 	{
+		BeginStep(4, "Loading Materials");
+		ProfileTimer materialLoad;
+		ImportSamplers(gltfModel, device);
+		ImportTextures(gltfModel);
+		ImportMaterials(gltfModel);
+		_timeMaterialLoad = materialLoad.Get();
+	}
+	{
+		BeginStep(5, "Processing Meshes");
 		ProfileTimer meshLoad;
 		ImportMeshes(gltfModel, device);
 		_timeMeshLoad = meshLoad.Get();
 	}
-	ImportNodes(gltfModel);
-	ImportSkins(gltfModel, device);
-	ImportAnimations(gltfModel);
+	{
+		BeginStep(6, "Loading Scene");
+		ProfileTimer sceneTimer;
+		ImportNodes(gltfModel);
+		_timeNodeLoad = sceneTimer.Get();
+		sceneTimer.Reset();
+		ImportSkins(gltfModel, device);
+		_timeSkinLoad = sceneTimer.Get();
+		sceneTimer.Reset();
+		ImportAnimations(gltfModel);
+		_timeAnimationLoad = sceneTimer.Get();
+	}
+
+	_buffers.clear();
+	_bufferFiles.clear();
+	_textureImages.clear();
 
 	Name                  = gltfPath.filename().string();
 	const auto& gltfScene = gltfModel.scenes[gltfModel.defaultScene ? gltfModel.defaultScene.value() : 0];
 	if (!gltfScene.name.empty()) { Name = gltfScene.name; }
 
+	UpdateTransforms();
 	for (auto* nodePtr : RootNodes) { CalculateBounds(nodePtr, nullptr); }
 	for (auto& node : _nodes) {
 		if (node->BVH.Valid) {
@@ -337,26 +623,135 @@ Model::Model(tk::Device& device, const std::filesystem::path& gltfPath) {
 
 	ResetAnimation();
 
-	const double timeLoad = loadTimer.Get();
-	std::cout << "\tLoading completed in " << timeLoad * 1000.0 << "ms.\n";
-	std::cout << "\t\tglTF Parse: " << _timeParse * 1000.0 << "ms" << std::endl;
-	std::cout << "\t\tBuffer Load: " << _timeBufferLoad * 1000.0 << "ms" << std::endl;
-	std::cout << "\t\tMesh Load: " << _timeMeshLoad * 1000.0 << "ms" << std::endl;
-	std::cout << "\t\t\tLoad Vertices: " << _timeVertexLoad * 1000.0 << "ms" << std::endl;
-	std::cout << "\t\t\tUnpack Vertices: " << _timeUnpackVertices * 1000.0 << "ms" << std::endl;
-	std::cout << "\t\t\tGenerate Flat Normals: " << _timeGenerateFlatNormals * 1000.0 << "ms" << std::endl;
-	std::cout << "\t\t\tGenerate Tangent Space: " << _timeGenerateTangents * 1000.0 << "ms" << std::endl;
-	std::cout << "\t\t\tWeld Vertices: " << _timeWeldVertices * 1000.0 << "ms" << std::endl;
+	BuildLoadProfile(gltfPath, loadTimer.Get());
+	if (_options.PrintProfile) { LoadProfile.Print(std::cout); }
+}
+
+void Model::BuildLoadProfile(const std::filesystem::path& gltfPath, double timeLoad) {
+	static constexpr double MiB = 1024.0 * 1024.0;
+
+	LoadProfile.ModelName  = Name;
+	LoadProfile.SourcePath = gltfPath.string();
+	auto& total            = LoadProfile.Total;
+	total                  = LoadProfileStage("Load", timeLoad);
+
+	total.Add("glTF Parse", _timeParse, _gltfDataSize);
+	total.Add("Buffer Load", _timeBufferLoad, _bufferDataSize);
+	if (UseGeometryCache) { total.Add("Geometry Hash", _timeGeometryHash, _geometryHashDataSize); }
+
+	auto& images = total.Add("Image Load", _timeImageLoad, 0, Images.size());
+	auto& hash   = images.Add("Hash Images", _timeImageHash, _imageSourceDataSize);
+	if (_imagesShared > 0) { hash.Note = std::to_string(_imagesShared) + " shared"; }
+	auto& decode = images.Add("Decode Images", _timeImageDecode, 0, _imageDecodeStages.size());
+	for (const auto& stage : _imageDecodeStages) { decode.Bytes += stage.Bytes; }
+	decode.Children = std::move(_imageDecodeStages);
+	if (_texturesCompressed + _texturesFromCache > 0) {
+		auto& compress = images.Add("Compress Images",
+		                            _timeImageCompress,
+		                            _uncompressedImageDataSize,
+		                            _texturesCompressed + _texturesFromCache);
+		std::ostringstream note;
+		note << _texturesCompressed << " compressed, " << _texturesFromCache << " cached, "
+		     << _compressedImageDataSize / MiB << "MiB stored";
+		compress.Note = note.str();
+	}
+	images.Add("Upload Images", _timeImageUpload, _imageUploadDataSize);
+
+	total.Add("Material Load", _timeMaterialLoad, 0, Materials.size());
+
+	auto& meshes = total.Add("Mesh Load", _timeMeshLoad, _meshDataSize, Meshes.size());
+	if (UseGeometryCache) {
+		meshes.Add(_geometryCacheHit ? "Geometry Cache Hit" : "Geometry Cache Miss", _timeGeometryCache);
+	}
+	meshes.Add("Load Vertices", _timeVertexLoad);
+	meshes.Add("Unpack Vertices", _timeUnpackVertices, _unpackedVertexDataSize);
+	meshes.Add("Generate Flat Normals", _timeGenerateFlatNormals);
+	meshes.Add("Generate Tangent Space", _timeGenerateTangents);
+	meshes.Add("Weld Vertices", _timeWeldVertices);
+	if (_vertexCacheBefore.Triangles > 0) {
+		std::ostringstream note;
+		note << "ACMR " << _vertexCacheBefore.ACMR() << " -> " << _vertexCacheAfter.ACMR() << ", ATVR "
+		     << _vertexCacheBefore.ATVR() << " -> " << _vertexCacheAfter.ATVR();
+		meshes.Add("Optimize Vertex Cache", _timeOptimizeVertexCache).Note = note.str();
+	}
+	if (_overdrawBefore.PixelsCovered > 0) {
+		std::ostringstream note;
+		note << "Overdraw " << _overdrawBefore.Overdraw() << " -> " << _overdrawAfter.Overdraw();
+		meshes.Add("Optimize Overdraw", _timeOptimizeOverdraw).Note = note.str();
+	}
+	if (_meshletStats.Meshlets > 0) {
+		std::ostringstream note;
+		note << _meshletStats.AverageVertices() << " vertices and " << _meshletStats.AverageTriangles()
+		     << " triangles on average";
+		meshes.Add("Build Meshlets", _timeBuildMeshlets, 0, _meshletStats.Meshlets).Note = note.str();
+	}
+	if (_lodCount > 0) {
+		meshes.Add("Generate LODs", _timeGenerateLods, 0, _lodCount).Note = std::to_string(_lodIndexCount) + " indices";
+	}
+	if (_vertexFetchBefore.BytesUsed > 0) {
+		std::ostringstream note;
+		note << "Overfetch " << _vertexFetchBefore.Overfetch() << " -> " << _vertexFetchAfter.Overfetch();
+		meshes.Add("Optimize Vertex Fetch", _timeOptimizeVertexFetch).Note = note.str();
+	}
+	{
+		std::ostringstream note;
+		note << "vertices " << _unpackedVertexDataSize / MiB << "MiB -> " << _vertexDataSize / MiB << "MiB, indices "
+		     << _unpackedIndexDataSize / MiB << "MiB -> " << _indexDataSize / MiB << "MiB";
+		meshes.Add("Pack Vertices", _timePackVertices, _vertexDataSize + _indexDataSize).Note = note.str();
+	}
+	meshes.Add("Upload Meshes", _timeMeshUpload, _meshDataSize);
+	auto& perMesh = meshes.Add("Meshes", 0.0, 0, _meshStages.size());
+	for (const auto& stage : _meshStages) {
+		perMesh.Time += stage.Time;
+		perMesh.Bytes += stage.Bytes;
+	}
+	perMesh.Children = std::move(_meshStages);
+
+	auto& scene = total.Add("Scene Load", _timeNodeLoad + _timeSkinLoad + _timeAnimationLoad);
+	scene.Add("Import Nodes", _timeNodeLoad, 0, _nodes.size());
+	scene.Add("Import Skins", _timeSkinLoad, 0, Skins.size());
+	auto& animations = scene.Add("Import Animations", _timeAnimationLoad, _animationDataSize, Animations.size());
+	if (_animationKeys > 0) {
+		std::ostringstream note;
+		note << _animationKeysKept << " of " << _animationKeys << " keys kept, " << _unpackedAnimationDataSize / MiB
+		     << "MiB -> " << _animationDataSize / MiB << "MiB";
+		animations.Note = note.str();
+	}
 }
 
 void Model::ResetAnimation() {
 	for (auto& node : _nodes) { node->ResetAnimation(); }
 }
 
+void Model::UpdateTransforms() {
+	// Parents come first, so by the time we reach a node, its parent's world transforms are final and we know whether
+	// they changed. A node is only recomputed if it or one of its ancestors changed.
+	for (size_t i = 0; i < _transformNodes.size(); ++i) {
+		Node* node           = _transformNodes[i];
+		const int32_t parent = _transformParents[i];
+
+		NodeDirtyFlags changed = node->DirtyFlags;
+		if (parent >= 0) { changed |= _transformChanged[parent]; }
+		_transformChanged[i] = changed;
+		if (!changed) { continue; }
+
+		if (changed & NodeDirtyBits::Rest) {
+			if (node->DirtyFlags & NodeDirtyBits::Rest) { _localTransforms[i] = node->GetLocalTransform(); }
+			_worldTransforms[i] = parent >= 0 ? _worldTransforms[parent] * _localTransforms[i] : _localTransforms[i];
+		}
+		if (changed & NodeDirtyBits::Anim) {
+			if (node->DirtyFlags & NodeDirtyBits::Anim) { _animLocalTransforms[i] = node->GetAnimLocalTransform(); }
+			_animWorldTransforms[i] =
+				parent >= 0 ? _animWorldTransforms[parent] * _animLocalTransforms[i] : _animLocalTransforms[i];
+		}
+		node->DirtyFlags = {};
+	}
+}
+
 void Model::CalculateBounds(Node* node, Node* parent) {
 	if (node->Mesh) {
 		if (node->Mesh->Bounds.Valid) {
-			node->AABB = node->Mesh->Bounds.Transform(node->GetGlobalTransform());
+			node->AABB = node->Mesh->Bounds.Transform(GetWorldTransform(node));
 			if (node->Children.size() == 0) {
 				node->BVH       = node->AABB;
 				node->BVH.Valid = true;
@@ -372,8 +767,28 @@ void Model::ImportAnimations(const fastgltf::Asset& gltfModel) {
 		const auto& gltfAnimation = gltfModel.animations[i];
 		auto& animation           = Animations.emplace_back(std::make_shared<Animation>());
 		animation->Name           = "Animation " + std::to_string(i);
+		animation->StartTime      = std::numeric_limits<float>::max();
+		animation->EndTime        = std::numeric_limits<float>::lowest();
 		if (!gltfAnimation.name.empty()) { animation->Name = gltfAnimation.name; }
 
+		// Samplers with the same key times share one track of them, whether or not they read the same accessor.
+		std::unordered_map<tk::Hash, std::vector<uint32_t>> timeTracks;
+		auto AddTimeTrack = [&](std::vector<float>&& times) -> uint32_t {
+			tk::Hasher hasher;
+			hasher.Data(times.size() * sizeof(float), times.data());
+			auto& tracks = timeTracks[hasher.Get()];
+			for (const uint32_t track : tracks) {
+				if (animation->TimeTracks[track] == times) { return track; }
+			}
+
+			const uint32_t track = static_cast<uint32_t>(animation->TimeTracks.size());
+			_animationDataSize += times.size() * sizeof(float);
+			animation->TimeTracks.push_back(std::move(times));
+			tracks.push_back(track);
+
+			return track;
+		};
+
 		for (const auto& gltfSampler : gltfAnimation.samplers) {
 			auto& sampler = animation->Samplers.emplace_back();
 
@@ -389,41 +804,42 @@ void Model::ImportAnimations(const fastgltf::Asset& gltfModel) {
 					sampler.Interpolation = AnimationInterpolation::Linear;
 					break;
 			}
+			const bool cubic = sampler.Interpolation == AnimationInterpolation::CubicSpline;
 
 			// Input data
+			std::vector<float> times;
 			{
-				const auto& gltfAccessor   = gltfModel.accessors[gltfSampler.inputAccessor];
-				const auto& gltfBufferView = gltfModel.bufferViews[gltfAccessor.bufferViewIndex.value()];
-				const auto& gltfBuffer     = gltfModel.buffers[gltfBufferView.bufferIndex];
-				const float* inputData =
-					reinterpret_cast<const float*>(&gltfBuffer.data.bytes[gltfAccessor.byteOffset + gltfBufferView.byteOffset]);
-				sampler.Inputs.resize(gltfAccessor.count);
-				memcpy(sampler.Inputs.data(), inputData, gltfAccessor.count * sizeof(float));
-
-				for (const float input : sampler.Inputs) {
+				const auto& gltfAccessor = gltfModel.accessors[gltfSampler.inputAccessor];
+				const float* inputData   = reinterpret_cast<const float*>(GetAccessorBytes(gltfModel, _buffers, gltfAccessor));
+				times.resize(gltfAccessor.count);
+				memcpy(times.data(), inputData, gltfAccessor.count * sizeof(float));
+
+				for (const float input : times) {
 					animation->StartTime = std::min(animation->StartTime, input);
 					animation->EndTime   = std::max(animation->EndTime, input);
 				}
 			}
 
 			// Output data
+			std::vector<glm::vec4> values;
+			bool quaternion = false;
 			{
-				const auto& gltfAccessor   = gltfModel.accessors[gltfSampler.outputAccessor];
-				const auto& gltfBufferView = gltfModel.bufferViews[gltfAccessor.bufferViewIndex.value()];
-				const auto& gltfBuffer     = gltfModel.buffers[gltfBufferView.bufferIndex];
-				const void* outputData     = &gltfBuffer.data.bytes[gltfAccessor.byteOffset + gltfBufferView.byteOffset];
-				sampler.Outputs.resize(gltfAccessor.count);
+				const auto& gltfAccessor = gltfModel.accessors[gltfSampler.outputAccessor];
+				const void* outputData   = GetAccessorBytes(gltfModel, _buffers, gltfAccessor);
 
 				switch (gltfAccessor.type) {
 					case fastgltf::AccessorType::Vec3: {
 						const glm::vec3* src = reinterpret_cast<const glm::vec3*>(outputData);
-						for (size_t i = 0; i < gltfAccessor.count; ++i) { sampler.Outputs[i] = glm::vec4(src[i], 0.0f); }
+						values.resize(gltfAccessor.count);
+						for (size_t i = 0; i < gltfAccessor.count; ++i) { values[i] = glm::vec4(src[i], 0.0f); }
 						break;
 					}
 
+					// Rotations are the only vec4 outputs.
 					case fastgltf::AccessorType::Vec4: {
 						const glm::vec4* src = reinterpret_cast<const glm::vec4*>(outputData);
-						memcpy(sampler.Outputs.data(), src, gltfAccessor.count * sizeof(glm::vec4));
+						values.assign(src, src + gltfAccessor.count);
+						quaternion = true;
 						break;
 					}
 
@@ -431,7 +847,52 @@ void Model::ImportAnimations(const fastgltf::Asset& gltfModel) {
 						break;
 				}
 			}
+
+			// Only keep as many keys as there are values for, so that sampling never reads past the outputs.
+			const size_t stride = cubic ? 3 : 1;
+			if (values.size() < times.size() * stride) { times.resize(values.size() / stride); }
+			values.resize(times.size() * stride);
+			_animationKeys += times.size();
+			_unpackedAnimationDataSize += times.size() * sizeof(float) + values.size() * sizeof(glm::vec4);
+
+			// Cubic spline keys shape the curve on either side of them through their tangents, so they are all kept.
+			if (ReduceAnimationKeys && !cubic && times.size() > 1) {
+				float tolerance = RotationKeyTolerance;
+				if (!quaternion) {
+					glm::vec4 min = values[0];
+					glm::vec4 max = values[0];
+					for (const auto& value : values) {
+						min = glm::min(min, value);
+						max = glm::max(max, value);
+					}
+					const glm::vec4 extent = max - min;
+					tolerance = VectorKeyTolerance * std::max(std::max(extent.x, extent.y), std::max(extent.z, extent.w));
+				}
+
+				std::vector<uint32_t> kept;
+				if (sampler.Interpolation == AnimationInterpolation::Step) {
+					kept = ReduceStepKeys(values, tolerance);
+				} else {
+					kept = ReduceLinearKeys(times, values, quaternion, tolerance);
+				}
+				for (size_t i = 0; i < kept.size(); ++i) {
+					times[i]  = times[kept[i]];
+					values[i] = values[kept[i]];
+				}
+				times.resize(kept.size());
+				values.resize(kept.size());
+			}
+			_animationKeysKept += times.size();
+
+			// Cubic spline rotations are blended component by component, so flipping the sign of a key as smallest-three does
+			// would bend the curve, and their tangents are not unit quaternions at all. They are quantized by range instead.
+			KeyEncoding encoding = KeyEncoding::Vector3;
+			if (quaternion) { encoding = cubic ? KeyEncoding::Vector4 : KeyEncoding::Quaternion; }
+			sampler.Keys  = QuantizeKeys(values, encoding);
+			sampler.Times = AddTimeTrack(std::move(times));
+			_animationDataSize += sampler.Keys.GetByteSize();
 		}
+		if (animation->StartTime > animation->EndTime) { animation->StartTime = animation->EndTime = 0.0f; }
 
 		for (const auto& gltfChannel : gltfAnimation.channels) {
 			auto& channel = animation->Channels.emplace_back();
@@ -455,105 +916,423 @@ void Model::ImportAnimations(const fastgltf::Asset& gltfModel) {
 	}
 }
 
-void Model::ImportImages(const fastgltf::Asset& gltfModel, const std::filesystem::path& gltfPath, tk::Device& device) {
-	const auto gltfFolder = gltfPath.parent_path();
-	// Quickly iterate over materials to find what format each image should be, Srgb or Unorm.
+void Model::ImportImages(const fastgltf::Asset& gltfModel, const std::filesystem::path& gltfPath, tk::Device* device) {
+	// Without a device, every format is assumed to be supported, so that the same work is done as on a capable one.
+	auto FormatSupported = [device](vk::Format format, vk::FormatFeatureFlags features) {
+		return !device || device->ImageFormatSupported(format, features, vk::ImageTiling::eOptimal);
+	};
+	auto& imageCache = ImageCache::Get(device);
+
+	ProfileTimer imageTimer;
+
+	// With KHR_texture_basisu, a texture's image is its KTX2 source, and its fallback is an ordinary PNG or JPEG. Most
+	// KTX2 sources hold Basis Universal data, which we cannot transcode, so the KTX2 image is only used if it can be
+	// uploaded as it is. Anything else, including a container which fails to parse, is replaced by the fallback.
+	const auto Ktx2Uploadable = [&](size_t imageIndex) -> bool {
+		const auto& gltfImage = gltfModel.images[imageIndex];
+		MappedFile file;
+		std::span<const uint8_t> bytes;
+		try {
+			if (gltfImage.location == fastgltf::DataLocation::FilePathWithByteRange) {
+				file  = MappedFile(gltfImage.data.path);
+				bytes = file.Bytes();
+			} else if (gltfImage.location == fastgltf::DataLocation::BufferViewWithMime) {
+				const auto& gltfBufferView = gltfModel.bufferViews[gltfImage.data.bufferViewIndex];
+				bytes = _buffers[gltfBufferView.bufferIndex].subspan(gltfBufferView.byteOffset, gltfBufferView.byteLength);
+			} else if (gltfImage.location == fastgltf::DataLocation::VectorWithMime) {
+				bytes = gltfImage.data.bytes;
+			}
+			if (!IsKtx2(bytes.data(), bytes.size())) { return false; }
+			const Ktx2Image ktx2 = ParseKtx2(bytes.data(), bytes.size());
+
+			return FormatSupported(ktx2.Format, vk::FormatFeatureFlagBits::eSampledImage);
+		} catch (const std::exception&) { return false; }
+	};
+	_textureImages.resize(gltfModel.textures.size());
+	for (size_t i = 0; i < gltfModel.textures.size(); ++i) {
+		const auto& gltfTexture = gltfModel.textures[i];
+		if (gltfTexture.fallbackImageIndex && (!gltfTexture.imageIndex || !Ktx2Uploadable(*gltfTexture.imageIndex))) {
+			_textureImages[i] = gltfTexture.fallbackImageIndex.value();
+		} else {
+			_textureImages[i] = gltfTexture.imageIndex.value();
+		}
+	}
+
+	// Quickly iterate over materials to find what each image is used for, and from that what format it should be, Srgb
+	// or Unorm.
 	std::vector<vk::Format> textureFormats(gltfModel.images.size(), vk::Format::eUndefined);
-	const auto EnsureFormat = [&](uint32_t index, vk::Format expected) -> void {
-		auto& format = textureFormats[gltfModel.textures[index].imageIndex.value()];
+	std::vector<uint32_t> textureUsages(gltfModel.images.size(), 0);
+	const auto AddUsage = [&](uint32_t index, TextureUsage usage) -> void {
+		const size_t imageIndex   = _textureImages[index];
+		const bool srgb           = usage == TextureUsageBaseColor || usage == TextureUsageEmissive;
+		const vk::Format expected = srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+		auto& format              = textureFormats[imageIndex];
 		if (format != vk::Format::eUndefined && format != expected) {
 			std::cerr << "[GltfImporter] Texture index " << index << " is used in both Srgb and Unorm contexts!\n";
 		}
 		format = expected;
+		textureUsages[imageIndex] |= usage;
 	};
 	for (size_t i = 0; i < gltfModel.materials.size(); ++i) {
 		const auto& gltfMaterial = gltfModel.materials[i];
 
 		if (gltfMaterial.pbrData) {
 			const auto& pbr = gltfMaterial.pbrData.value();
-			if (pbr.baseColorTexture) { EnsureFormat(pbr.baseColorTexture->textureIndex, vk::Format::eR8G8B8A8Srgb); }
+			if (pbr.baseColorTexture) { AddUsage(pbr.baseColorTexture->textureIndex, TextureUsageBaseColor); }
 			if (pbr.metallicRoughnessTexture) {
-				EnsureFormat(pbr.metallicRoughnessTexture->textureIndex, vk::Format::eR8G8B8A8Unorm);
+				AddUsage(pbr.metallicRoughnessTexture->textureIndex, TextureUsageMetallicRoughness);
 			}
 		}
-		if (gltfMaterial.normalTexture) {
-			EnsureFormat(gltfMaterial.normalTexture->textureIndex, vk::Format::eR8G8B8A8Unorm);
-		}
-		if (gltfMaterial.emissiveTexture) {
-			EnsureFormat(gltfMaterial.emissiveTexture->textureIndex, vk::Format::eR8G8B8A8Srgb);
-		}
+		if (gltfMaterial.normalTexture) { AddUsage(gltfMaterial.normalTexture->textureIndex, TextureUsageNormal); }
+		if (gltfMaterial.emissiveTexture) { AddUsage(gltfMaterial.emissiveTexture->textureIndex, TextureUsageEmissive); }
 		if (gltfMaterial.occlusionTexture) {
-			EnsureFormat(gltfMaterial.occlusionTexture->textureIndex, vk::Format::eR8G8B8A8Unorm);
+			AddUsage(gltfMaterial.occlusionTexture->textureIndex, TextureUsageOcclusion);
 		}
 	}
+
+	// Gather the encoded bytes for every image we need. Images embedded in the glTF are referenced in place, while
+	// external files are mapped by the workers before hashing. Only the image chosen for each texture above is read, so
+	// a texture with a usable KTX2 source never touches its fallback, and vice versa.
+	struct ImageSource {
+		std::string Name;
+		std::filesystem::path Path;
+		const uint8_t* Data = nullptr;
+		size_t Size         = 0;
+		MappedFile File;
+	};
+	struct DecodedImage {
+		stbi_uc* Pixels   = nullptr;
+		int Width         = 0;
+		int Height        = 0;
+		double DecodeTime = 0.0;
+		std::string Error;
+		// Identifies the source bytes, and with them everything which decides the image's format, so that images already
+		// uploaded by this or another model can be shared.
+		tk::Hash ContentHash = 0;
+		tk::Hash ImageKey    = 0;
+		std::shared_ptr<Image> Shared;
+		std::optional<size_t> DuplicateOf;
+		// KTX2 images are not decoded at all. Their mip chain is uploaded straight from the source.
+		std::optional<Ktx2Image> Ktx2;
+		// Images which were block compressed, either just now or by an earlier import which cached the result.
+		std::optional<TextureCache> Compressed;
+		tk::Hash CacheKey   = 0;
+		bool CacheHit       = false;
+		double CompressTime = 0.0;
+		// Images which are neither are stored in Layout. If that differs from how stbi decoded them, their channels are
+		// repacked into Packed.
+		UncompressedLayout Layout;
+		std::vector<uint8_t> Packed;
+	};
+	std::vector<std::optional<ImageSource>> imageSources(gltfModel.images.size());
 	for (size_t i = 0; i < gltfModel.images.size(); ++i) {
 		const auto& gltfImage = gltfModel.images[i];
-		if (textureFormats[i] == vk::Format::eUndefined) {
-			Images.push_back(0);
+		if (textureFormats[i] == vk::Format::eUndefined) { continue; }
+
+		ImageSource source{.Name = gltfImage.name.empty() ? "Texture" + std::to_string(i) : gltfImage.name};
+		if (gltfImage.location == fastgltf::DataLocation::FilePathWithByteRange) {
+			source.Path = gltfImage.data.path;
+			source.Name = source.Path.filename().string();
+		} else if (gltfImage.location == fastgltf::DataLocation::BufferViewWithMime) {
+			const int bufferView                       = gltfImage.data.bufferViewIndex;
+			const fastgltf::BufferView& gltfBufferView = gltfModel.bufferViews[bufferView];
+			const auto& buffer                         = _buffers[gltfBufferView.bufferIndex];
+			source.Data                                = buffer.data() + gltfBufferView.byteOffset;
+			source.Size                                = gltfBufferView.byteLength;
+		} else if (gltfImage.location == fastgltf::DataLocation::VectorWithMime) {
+			source.Data = gltfImage.data.bytes.data();
+			source.Size = gltfImage.data.bytes.size();
+		} else {
+			std::cerr << "[GltfLoader] Failed to find data source for texture for image '" << gltfImage.name << "'!\n";
 			continue;
 		}
 
-		std::filesystem::path texturePath = "Texture" + std::to_string(i);
-		bool loaded                       = false;
-		std::vector<uint8_t> bytes;
-		if (gltfImage.location == fastgltf::DataLocation::FilePathWithByteRange) {
-			const auto imagePath           = gltfImage.data.path;
-			texturePath                    = imagePath.stem();
-			const std::string imagePathStr = imagePath.string();
-			const char* imagePathC         = imagePathStr.c_str();
+		imageSources[i] = std::move(source);
+	}
+
+	// Choose the block compressed format for each image, as long as the device can sample it.
+	std::vector<vk::Format> compressedFormats(gltfModel.images.size(), vk::Format::eUndefined);
+	if (CompressTextures) {
+		for (size_t i = 0; i < gltfModel.images.size(); ++i) {
+			if (!imageSources[i]) { continue; }
+			const vk::Format format =
+				MatchColorSpace(ChooseCompressedFormat(textureUsages[i]), tk::FormatIsSrgb(textureFormats[i]));
+			if (FormatSupported(format, vk::FormatFeatureFlagBits::eSampledImage)) { compressedFormats[i] = format; }
+		}
+	}
+
+	// Mipmaps are generated by blitting, so narrower Srgb formats need to support that as well as sampling.
+	const vk::FormatFeatureFlags mipmapFeatures =
+		vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eSampledImageFilterLinear |
+		vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst;
+	const bool narrowSrgb =
+		FormatSupported(vk::Format::eR8Srgb, mipmapFeatures) && FormatSupported(vk::Format::eR8G8Srgb, mipmapFeatures);
+
+	// Map and hash every image's source bytes, then look for images which have already been uploaded, either by another
+	// model which is still loaded or by an earlier image of this one. Those are shared rather than decoded again.
+	std::vector<DecodedImage> decodedImages(gltfModel.images.size());
+	ProfileTimer hashTimer;
+	ThreadPool::Get().ParallelFor(imageSources.size(), [&](size_t i) {
+		if (!imageSources[i]) { return; }
+		auto& source  = *imageSources[i];
+		auto& decoded = decodedImages[i];
+
+		if (!source.Path.empty()) {
 			try {
-				bytes = ReadFileBinary(imagePath);
+				source.File = MappedFile(source.Path);
 			} catch (const std::exception& e) {
-				std::cerr << "[GltfLoader] Failed to load texture: " << imagePath << "\n\t" << e.what() << "\n";
+				decoded.Error = "Failed to load texture: " + source.Path.string() + "\n\t" + e.what();
+				return;
+			}
+			source.Data = source.File.Data();
+			source.Size = source.File.Size();
+		}
+
+		decoded.ContentHash = GeometryCache::HashContents(source.Data, source.Size);
+		tk::Hasher h;
+		h(decoded.ContentHash);
+		h(static_cast<uint32_t>(textureFormats[i]));
+		h(textureUsages[i]);
+		h(static_cast<uint32_t>(compressedFormats[i]));
+		h(_options.UploadData);
+		decoded.ImageKey = h.Get();
+	});
+	{
+		std::unordered_map<tk::Hash, size_t> firstImages;
+		for (size_t i = 0; i < decodedImages.size(); ++i) {
+			auto& decoded = decodedImages[i];
+			if (!imageSources[i] || !decoded.Error.empty()) { continue; }
+			_imageSourceDataSize += imageSources[i]->Size;
+
+			decoded.Shared = imageCache.Find(decoded.ImageKey);
+			if (decoded.Shared) { continue; }
+			const auto [first, inserted] = firstImages.try_emplace(decoded.ImageKey, i);
+			if (!inserted) { decoded.DuplicateOf = first->second; }
+		}
+	}
+	_timeImageHash = hashTimer.Get();
+
+	// Decode every image on the thread pool. The device is not touched here, so this is purely CPU work. KTX2 images
+	// already hold GPU-ready data, and only need their headers read. Images to be block compressed are looked up in the
+	// texture cache by the hash of their encoded bytes first, and only decoded and compressed if they are not there.
+	stbi_set_flip_vertically_on_load(0);
+	{
+		ProfileTimer decodeTimer;
+
+		ThreadPool::Get().ParallelFor(imageSources.size(), [&](size_t i) {
+			if (!imageSources[i]) { return; }
+			const auto& source = *imageSources[i];
+			auto& decoded      = decodedImages[i];
+			if (!decoded.Error.empty() || decoded.Shared || decoded.DuplicateOf) { return; }
+			ProfileTimer timer;
+
+			const uint8_t* data   = source.Data;
+			const size_t dataSize = source.Size;
+			if (IsKtx2(data, dataSize)) {
+				try {
+					decoded.Ktx2 = ParseKtx2(data, dataSize);
+				} catch (const std::exception& e) { decoded.Error = std::string("Failed to read KTX2 texture: ") + e.what(); }
+				decoded.DecodeTime = timer.Get();
+				return;
+			}
+
+			const vk::Format compressedFormat = compressedFormats[i];
+			if (compressedFormat != vk::Format::eUndefined) {
+				tk::Hasher h;
+				h(TextureCache::FileVersion);
+				h(static_cast<uint32_t>(compressedFormat));
+				h(decoded.ContentHash);
+				decoded.CacheKey = h.Get();
+
+				TextureCache cache;
+				if (cache.Load(TextureCache::GetCachePath(decoded.CacheKey), decoded.CacheKey) &&
+				    cache.GetLevelCount() > 0) {
+					decoded.Compressed = std::move(cache);
+					decoded.CacheHit   = true;
+					decoded.DecodeTime = timer.Get();
+					return;
+				}
+			}
+
+			// The block compressors take RGBA, while other images are decoded with however many channels they have, and
+			// then cut down to the channels their users read.
+			const int desiredChannels = compressedFormat == vk::Format::eUndefined ? 0 : STBI_rgb_alpha;
+			int components;
+			decoded.Pixels = stbi_load_from_memory(
+				data, static_cast<int>(dataSize), &decoded.Width, &decoded.Height, &components, desiredChannels);
+			if (decoded.Pixels == nullptr) {
+				decoded.Error = std::string("Failed to read texture data: ") + stbi_failure_reason();
+			}
+
+			if (decoded.Pixels != nullptr && compressedFormat == vk::Format::eUndefined) {
+				const bool srgb    = tk::FormatIsSrgb(textureFormats[i]);
+				decoded.Layout     = ChooseUncompressedLayout(textureUsages[i], components, srgb, narrowSrgb);
+				const auto& layout = decoded.Layout;
+				bool repack        = layout.ChannelCount != static_cast<uint32_t>(components);
+				int sourceChannels[4];
+				for (uint32_t c = 0; c < layout.ChannelCount; ++c) {
+					sourceChannels[c] = GetSourceChannel(layout.Channels[c], components);
+					repack |= sourceChannels[c] != static_cast<int>(c);
+				}
+
+				if (repack) {
+					const size_t pixelCount = size_t(decoded.Width) * decoded.Height;
+					decoded.Packed.resize(pixelCount * layout.ChannelCount);
+					uint8_t* packed = decoded.Packed.data();
+					for (size_t p = 0; p < pixelCount; ++p) {
+						const uint8_t* pixel = decoded.Pixels + p * components;
+						for (uint32_t c = 0; c < layout.ChannelCount; ++c) {
+							*packed++ = sourceChannels[c] < 0 ? 255 : pixel[sourceChannels[c]];
+						}
+					}
+					stbi_image_free(decoded.Pixels);
+					decoded.Pixels = nullptr;
+				}
+			}
+			decoded.DecodeTime = timer.Get();
+
+			if (decoded.Pixels != nullptr && compressedFormat != vk::Format::eUndefined) {
+				ProfileTimer compressTimer;
+
+				// Compress the full mip chain, downsampling each level from the one before it.
+				const bool srgb = tk::FormatIsSrgb(compressedFormat);
+				TextureCache cache(compressedFormat, decoded.Width, decoded.Height);
+				uint32_t width             = decoded.Width;
+				uint32_t height            = decoded.Height;
+				const uint8_t* levelPixels = decoded.Pixels;
+				std::vector<uint8_t> downsampled;
+				while (true) {
+					cache.AddLevel(CompressImage(compressedFormat, levelPixels, width, height));
+					if (width == 1 && height == 1) { break; }
+					downsampled = DownsampleImage(levelPixels, width, height, srgb);
+					levelPixels = downsampled.data();
+					width       = std::max(width / 2, 1u);
+					height      = std::max(height / 2, 1u);
+				}
+				decoded.Compressed = std::move(cache);
+
+				stbi_image_free(decoded.Pixels);
+				decoded.Pixels       = nullptr;
+				decoded.CompressTime = compressTimer.Get();
+			}
+		});
+
+		_timeImageDecode = decodeTimer.Get();
+	}
+
+	// With every image decoded, create the GPU images in glTF order.
+	for (size_t i = 0; i < gltfModel.images.size(); ++i) {
+		auto& decoded = decodedImages[i];
+		if (!imageSources[i]) {
+			Images.push_back(0);
+			continue;
+		}
+		if (decoded.Shared || decoded.DuplicateOf) {
+			Images.push_back(decoded.Shared ? decoded.Shared : Images[*decoded.DuplicateOf]);
+			if (Images.back()) { ++_imagesShared; }
+			continue;
+		}
+		_imageDecodeStages.emplace_back(imageSources[i]->Name, decoded.DecodeTime, imageSources[i]->Size);
+
+		if (decoded.Ktx2) {
+			const auto& ktx2        = *decoded.Ktx2;
+			const vk::Format format = MatchColorSpace(ktx2.Format, tk::FormatIsSrgb(textureFormats[i]));
+			if (!FormatSupported(format, vk::FormatFeatureFlagBits::eSampledImage)) {
+				std::cerr << "[GltfLoader] KTX2 texture '" << imageSources[i]->Name << "' uses format "
+				          << vk::to_string(format) << ", which is not supported by this device.\n";
 				Images.push_back(0);
 				continue;
 			}
 
-			loaded = true;
-		} else if (gltfImage.location == fastgltf::DataLocation::BufferViewWithMime) {
-			const int bufferView                       = gltfImage.data.bufferViewIndex;
-			const fastgltf::BufferView& gltfBufferView = gltfModel.bufferViews[bufferView];
-			const fastgltf::Buffer& gltfBuffer         = gltfModel.buffers[gltfBufferView.bufferIndex];
-			const uint8_t* data                        = gltfBuffer.data.bytes.data() + gltfBufferView.byteOffset;
-			const size_t dataSize                      = gltfBufferView.byteLength;
-			bytes.resize(dataSize);
-			memcpy(bytes.data(), data, dataSize);
-
-			loaded = true;
-		} else if (gltfImage.location == fastgltf::DataLocation::VectorWithMime) {
-			bytes  = gltfImage.data.bytes;
-			loaded = true;
+			auto& image   = Images.emplace_back(new Image());
+			image->Format = format;
+			image->Size   = glm::uvec2(ktx2.Width, ktx2.Height);
+
+			// Mipmaps are generated by blitting, which compressed formats do not support.
+			const bool generateMipmaps =
+				ktx2.GenerateMipmaps && tk::GetFormatCompressionType(format) == tk::FormatCompressionType::Uncompressed;
+			tk::ImageCreateInfo imageCI = tk::ImageCreateInfo::Immutable2D(ktx2.Width, ktx2.Height, format, generateMipmaps);
+			if (!generateMipmaps) { imageCI.MipLevels = static_cast<uint32_t>(ktx2.Levels.size()); }
+			std::vector<tk::ImageInitialData> initialData;
+			for (const auto& level : ktx2.Levels) {
+				initialData.push_back({.Data = level.Data});
+				_imageUploadDataSize += level.Size;
+			}
+			ProfileTimer uploadTimer;
+			if (_options.UploadData) { image->Image = device->CreateImage(imageCI, initialData.data()); }
+			_timeImageUpload += uploadTimer.Get();
 
-			std::ofstream file("test.jpg", std::ios::binary);
-			file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
-			file.close();
+			imageCache.Add(decoded.ImageKey, image);
+			decoded.Ktx2.reset();
+			continue;
 		}
-		if (!loaded) {
-			std::cerr << "[GltfLoader] Failed to find data source for texture for image '" << gltfImage.name << "'!\n";
-			Images.push_back(0);
+
+		if (decoded.Compressed) {
+			const auto& cache = *decoded.Compressed;
+			_timeImageCompress += decoded.CompressTime;
+			if (decoded.CacheHit) {
+				++_texturesFromCache;
+			} else {
+				++_texturesCompressed;
+				const auto cachePath = TextureCache::GetCachePath(decoded.CacheKey);
+				try {
+					cache.Save(cachePath, decoded.CacheKey);
+				} catch (const std::exception& e) {
+					std::cerr << "[GltfImporter] Failed to write texture cache " << cachePath.string() << ": " << e.what()
+					          << std::endl;
+				}
+			}
+
+			auto& image   = Images.emplace_back(new Image());
+			image->Format = cache.GetFormat();
+			image->Size   = glm::uvec2(cache.GetWidth(), cache.GetHeight());
+
+			tk::ImageCreateInfo imageCI = tk::ImageCreateInfo::Immutable2D(image->Size.x, image->Size.y, image->Format);
+			imageCI.MipLevels           = static_cast<uint32_t>(cache.GetLevelCount());
+			std::vector<tk::ImageInitialData> initialData;
+			for (size_t level = 0; level < cache.GetLevelCount(); ++level) {
+				initialData.push_back({.Data = cache.GetLevel(level).data()});
+				const uint32_t levelWidth  = std::max(image->Size.x >> level, 1u);
+				const uint32_t levelHeight = std::max(image->Size.y >> level, 1u);
+				_uncompressedImageDataSize += size_t(levelWidth) * levelHeight * 4;
+			}
+			ProfileTimer uploadTimer;
+			if (_options.UploadData) { image->Image = device->CreateImage(imageCI, initialData.data()); }
+			_timeImageUpload += uploadTimer.Get();
+			_compressedImageDataSize += cache.GetDataSize();
+			_imageUploadDataSize += cache.GetDataSize();
+			imageCache.Add(decoded.ImageKey, image);
+
+			decoded.Compressed.reset();
 			continue;
 		}
 
-		int width, height, components;
-		stbi_set_flip_vertically_on_load(0);
-		stbi_uc* pixels = stbi_load_from_memory(bytes.data(), bytes.size(), &width, &height, &components, STBI_rgb_alpha);
-		if (pixels == nullptr) {
-			std::cerr << "[GltfLoader] Failed to read texture data: " << stbi_failure_reason() << "\n";
+		if (decoded.Pixels == nullptr && decoded.Packed.empty()) {
+			std::cerr << "[GltfLoader] " << decoded.Error << "\n";
 			Images.push_back(0);
 			continue;
 		}
-		const size_t byteSize = width * height * 4;
 
 		auto& image   = Images.emplace_back(new Image());
-		image->Format = textureFormats[i];
-		image->Size   = glm::uvec2(width, height);
-
-		const tk::ImageCreateInfo imageCI      = tk::ImageCreateInfo::Immutable2D(width, height, image->Format, true);
-		const tk::ImageInitialData initialData = {.Data = pixels};
-		image->Image                           = device.CreateImage(imageCI, &initialData);
-
-		stbi_image_free(pixels);
+		image->Format = decoded.Layout.Format;
+		image->Size   = glm::uvec2(decoded.Width, decoded.Height);
+
+		tk::ImageCreateInfo imageCI =
+			tk::ImageCreateInfo::Immutable2D(decoded.Width, decoded.Height, image->Format, true);
+		imageCI.Swizzle                        = decoded.Layout.Swizzle;
+		const tk::ImageInitialData initialData = {.Data = decoded.Pixels ? decoded.Pixels : decoded.Packed.data()};
+		ProfileTimer uploadTimer;
+		if (_options.UploadData) { image->Image = device->CreateImage(imageCI, &initialData); }
+		_timeImageUpload += uploadTimer.Get();
+		_imageUploadDataSize += size_t(decoded.Width) * decoded.Height * decoded.Layout.ChannelCount;
+		imageCache.Add(decoded.ImageKey, image);
+
+		stbi_image_free(decoded.Pixels);
+		decoded.Pixels = nullptr;
+		decoded.Packed = {};
 	}
+
+	_timeImageLoad = imageTimer.Get();
 }
 
 void Model::ImportMaterials(const fastgltf::Asset& gltfModel) {
@@ -574,8 +1353,9 @@ void Model::ImportMaterials(const fastgltf::Asset& gltfModel) {
 	for (size_t i = 0; i < gltfModel.materials.size(); ++i) {
 		const auto& gltfMaterial = gltfModel.materials[i];
 
-		auto& material = Materials.emplace_back(new Material());
-		material->Name = gltfMaterial.name;
+		auto& material       = Materials.emplace_back(new Material());
+		material->Name       = gltfMaterial.name;
+		material->UploadData = _options.UploadData;
 
 		if (gltfMaterial.pbrData) {
 			const auto& pbr = gltfMaterial.pbrData.value();
@@ -631,7 +1411,8 @@ void Model::ImportMaterials(const fastgltf::Asset& gltfModel) {
 
 	// Create 1 additional material with nothing but defaults, to be used if any mesh primitive does not specify a
 	// material.
-	_defaultMaterial = Materials.emplace_back(new Material()).get();
+	_defaultMaterial             = Materials.emplace_back(new Material()).get();
+	_defaultMaterial->UploadData = _options.UploadData;
 }
 
 static VertexAttributes GetAvailableAttributes(const fastgltf::Primitive& prim) {
@@ -672,12 +1453,18 @@ static MeshProcessingSteps GetProcessingSteps(VertexAttributes attributes) {
 		// No indices provided. We will weld the mesh and create our own index buffer.
 		steps |= MeshProcessingStepBits::WeldVertices;
 	}
+	if (VertexCacheOrder) { steps |= MeshProcessingStepBits::OptimizeVertexCache; }
+	if (OverdrawOrder) { steps |= MeshProcessingStepBits::OptimizeOverdraw; }
+	if (GenerateMeshlets) { steps |= MeshProcessingStepBits::BuildMeshlets; }
+	if (GenerateLods) { steps |= MeshProcessingStepBits::GenerateLods; }
+	if (VertexFetchOrder) { steps |= MeshProcessingStepBits::OptimizeVertexFetch; }
 
 	return steps;
 }
 
 template <typename Source, typename Destination>
 static std::vector<Destination> ConvertAccessorData(const fastgltf::Asset& gltfModel,
+                                                    const BufferData& buffers,
                                                     const fastgltf::Accessor& gltfAccessor,
                                                     bool vertexAccessor) {
 	static_assert(AccessorType<Destination>::Count > 0, "Unknown type conversion given to ConvertAccessorData");
@@ -695,10 +1482,25 @@ static std::vector<Destination> ConvertAccessorData(const fastgltf::Asset& gltfM
 	const auto count           = gltfAccessor.count;
 	const auto normalized      = gltfAccessor.normalized;
 	const auto& gltfBufferView = gltfModel.bufferViews[*gltfAccessor.bufferViewIndex];
-	const auto& gltfBuffer     = gltfModel.buffers[gltfBufferView.bufferIndex];
-	const uint8_t* bufferData  = &gltfBuffer.data.bytes[gltfAccessor.byteOffset + gltfBufferView.byteOffset];
+	const uint8_t* bufferData  = GetAccessorBytes(gltfModel, buffers, gltfAccessor);
 	const auto byteStride      = gltfBufferView.byteStride.value_or(vertexAccessor ? vertexStride : attrStride);
 
+	std::vector<Destination> dst(count);
+
+	// Nearly every accessor can go through the vectorized kernels, leaving only unusual conversions for the generic path.
+	constexpr auto srcFormat = ComponentFormatOf<Source>;
+	if constexpr (srcFormat != ComponentFormat::Unknown && std::is_same_v<D, float>) {
+		ConvertComponentsToFloat(
+			bufferData, byteStride, srcFormat, normalized, dstCount, count, reinterpret_cast<float*>(dst.data()));
+		return dst;
+	} else if constexpr (srcFormat != ComponentFormat::Unknown && std::is_same_v<D, uint32_t>) {
+		if (!normalized) {
+			ConvertComponentsToUint32(
+				bufferData, byteStride, srcFormat, dstCount, count, reinterpret_cast<uint32_t*>(dst.data()));
+			return dst;
+		}
+	}
+
 	auto Get = [bufferData, byteStride, normalized](size_t attributeIndex, uint8_t componentIndex) -> D {
 		const uint8_t* dataPtr = bufferData + (attributeIndex * byteStride) + (componentIndex * srcSize);
 		const Source v         = *reinterpret_cast<const Source*>(dataPtr);
@@ -714,8 +1516,6 @@ static std::vector<Destination> ConvertAccessorData(const fastgltf::Asset& gltfM
 		}
 	};
 
-	std::vector<Destination> dst(count);
-
 	if constexpr (dstCount == 1) {
 		for (size_t i = 0; i < count; ++i) { dst[i] = static_cast<D>(Get(i, 0)); }
 	} else {
@@ -732,6 +1532,7 @@ static std::vector<Destination> ConvertAccessorData(const fastgltf::Asset& gltfM
 
 template <typename T>
 static std::vector<T> GetAccessorData(const fastgltf::Asset& gltfModel,
+                                      const BufferData& buffers,
                                       const fastgltf::Accessor& gltfAccessor,
                                       bool vertexAccessor = false) {
 	constexpr auto outType          = AccessorType<T>::Type;
@@ -742,19 +1543,19 @@ static std::vector<T> GetAccessorData(const fastgltf::Asset& gltfModel,
 	if (outType == accessorType) {
 		switch (gltfAccessor.componentType) {
 			case fastgltf::ComponentType::Byte:
-				return ConvertAccessorData<int8_t, T>(gltfModel, gltfAccessor, vertexAccessor);
+				return ConvertAccessorData<int8_t, T>(gltfModel, buffers, gltfAccessor, vertexAccessor);
 			case fastgltf::ComponentType::UnsignedByte:
-				return ConvertAccessorData<uint8_t, T>(gltfModel, gltfAccessor, vertexAccessor);
+				return ConvertAccessorData<uint8_t, T>(gltfModel, buffers, gltfAccessor, vertexAccessor);
 			case fastgltf::ComponentType::Short:
-				return ConvertAccessorData<int16_t, T>(gltfModel, gltfAccessor, vertexAccessor);
+				return ConvertAccessorData<int16_t, T>(gltfModel, buffers, gltfAccessor, vertexAccessor);
 			case fastgltf::ComponentType::UnsignedShort:
-				return ConvertAccessorData<uint16_t, T>(gltfModel, gltfAccessor, vertexAccessor);
+				return ConvertAccessorData<uint16_t, T>(gltfModel, buffers, gltfAccessor, vertexAccessor);
 			case fastgltf::ComponentType::UnsignedInt:
-				return ConvertAccessorData<uint32_t, T>(gltfModel, gltfAccessor, vertexAccessor);
+				return ConvertAccessorData<uint32_t, T>(gltfModel, buffers, gltfAccessor, vertexAccessor);
 			case fastgltf::ComponentType::Float:
-				return ConvertAccessorData<float, T>(gltfModel, gltfAccessor, vertexAccessor);
+				return ConvertAccessorData<float, T>(gltfModel, buffers, gltfAccessor, vertexAccessor);
 			case fastgltf::ComponentType::Double:
-				return ConvertAccessorData<double, T>(gltfModel, gltfAccessor, vertexAccessor);
+				return ConvertAccessorData<double, T>(gltfModel, buffers, gltfAccessor, vertexAccessor);
 			default:
 				break;
 		}
@@ -765,11 +1566,12 @@ static std::vector<T> GetAccessorData(const fastgltf::Asset& gltfModel,
 
 template <typename T>
 static std::vector<T> GetAccessorData(const fastgltf::Asset& gltfModel,
+                                      const BufferData& buffers,
                                       const fastgltf::Primitive& gltfPrimitive,
                                       VertexAttributeBits attribute) {
 	if (attribute == VertexAttributeBits::Index) {
 		if (gltfPrimitive.indicesAccessor.has_value()) {
-			return GetAccessorData<T>(gltfModel, gltfModel.accessors[*gltfPrimitive.indicesAccessor]);
+			return GetAccessorData<T>(gltfModel, buffers, gltfModel.accessors[*gltfPrimitive.indicesAccessor]);
 		}
 	} else {
 		auto it = gltfPrimitive.attributes.end();
@@ -804,34 +1606,425 @@ static std::vector<T> GetAccessorData(const fastgltf::Asset& gltfModel,
 		}
 
 		if (it != gltfPrimitive.attributes.end()) {
-			return GetAccessorData<T>(gltfModel, gltfModel.accessors[it->second], true);
+			return GetAccessorData<T>(gltfModel, buffers, gltfModel.accessors[it->second], true);
 		}
 	}
 
 	return {};
 }
 
-void Model::ImportMeshes(const fastgltf::Asset& gltfModel, tk::Device& device) {
-	// Create a MikkTSpace context for tangent generation.
-	SMikkTSpaceContext mikktContext = {.m_pInterface = &MikkTInterface};
+// The result of loading and processing a single glTF primitive, ready to be appended to its submesh.
+struct ProcessedPrimitive {
+	std::vector<Vertex> Vertices;
+	std::vector<uint32_t> Indices;
+	MeshProcessingSteps Steps;
+	glm::vec3 BoundsMin = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 BoundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+
+	double TimeVertexLoad          = 0.0;
+	double TimeUnpackVertices      = 0.0;
+	double TimeGenerateFlatNormals = 0.0;
+	double TimeGenerateTangents    = 0.0;
+	double TimeWeldVertices        = 0.0;
+};
+
+// Load and process one primitive. This only reads from the glTF asset and material, so it is safe to run any number of
+// these concurrently.
+static void ProcessPrimitive(const fastgltf::Asset& gltfModel,
+                             const BufferData& buffers,
+                             const fastgltf::Primitive& gltfPrimitive,
+                             Material* material,
+                             ProcessedPrimitive& result) {
+	const auto primAttributes = GetAvailableAttributes(gltfPrimitive);
+	const auto primProcessing = GetProcessingSteps(primAttributes);
+
+	// Verify we have position data.
+	if (!(primAttributes & VertexAttributeBits::Position)) { return; }
+
+	auto& vertices = result.Vertices;
+	auto& indices  = result.Indices;
+	result.Steps   = primProcessing;
+
+	// Load the geometry data.
+	{
+		ProfileTimer loadVertices;
+
+		auto positions  = GetAccessorData<glm::vec3>(gltfModel, buffers, gltfPrimitive, VertexAttributeBits::Position);
+		auto normals    = GetAccessorData<glm::vec3>(gltfModel, buffers, gltfPrimitive, VertexAttributeBits::Normal);
+		auto tangents   = GetAccessorData<glm::vec4>(gltfModel, buffers, gltfPrimitive, VertexAttributeBits::Tangent);
+		auto texcoords0 = GetAccessorData<glm::vec2>(gltfModel, buffers, gltfPrimitive, VertexAttributeBits::Texcoord0);
+		auto texcoords1 = GetAccessorData<glm::vec2>(gltfModel, buffers, gltfPrimitive, VertexAttributeBits::Texcoord1);
+		auto colors0    = GetAccessorData<glm::vec4>(gltfModel, buffers, gltfPrimitive, VertexAttributeBits::Color0);
+		if (colors0.empty()) {
+			auto colors0v3 = GetAccessorData<glm::vec3>(gltfModel, buffers, gltfPrimitive, VertexAttributeBits::Color0);
+			if (!colors0v3.empty()) {
+				colors0.reserve(colors0v3.size());
+				for (const auto& c : colors0v3) { colors0.push_back(glm::vec4(c, 1.0f)); }
+			}
+		}
+		auto joints0  = GetAccessorData<glm::uvec4>(gltfModel, buffers, gltfPrimitive, VertexAttributeBits::Joints0);
+		auto weights0 = GetAccessorData<glm::vec4>(gltfModel, buffers, gltfPrimitive, VertexAttributeBits::Weights0);
+
+		normals.resize(positions.size());
+		tangents.resize(positions.size());
+		texcoords0.resize(positions.size());
+		texcoords1.resize(positions.size());
+		colors0.resize(positions.size(), glm::vec4(1, 1, 1, 1));
+		joints0.resize(positions.size());
+		weights0.resize(positions.size());
+
+		vertices.reserve(positions.size());
+		for (size_t i = 0; i < positions.size(); ++i) {
+			vertices.push_back(Vertex{.Position  = positions[i],
+			                          .Normal    = normals[i],
+			                          .Tangent   = tangents[i],
+			                          .Texcoord0 = texcoords0[i],
+			                          .Texcoord1 = texcoords1[i],
+			                          .Color0    = colors0[i],
+			                          .Joints0   = joints0[i],
+			                          .Weights0  = weights0[i]});
+		}
+
+		indices = GetAccessorData<uint32_t>(gltfModel, buffers, gltfPrimitive, VertexAttributeBits::Index);
+
+		result.TimeVertexLoad += loadVertices.Get();
+	}
+
+	// Pre-Processing: Unpack vertices
+	if (primProcessing & MeshProcessingStepBits::UnpackVertices) {
+		ProfileTimer timeUnpack;
+
+		if (indices.size() > 0) {
+			std::vector<Vertex> newVertices(indices.size());
+
+			uint32_t newIndex = 0;
+			for (const uint32_t index : indices) { newVertices[newIndex++] = vertices[index]; }
+			vertices = std::move(newVertices);
+			indices.clear();
+		}
+
+		result.TimeUnpackVertices += timeUnpack.Get();
+	}
+
+	// Pre-Processing: Flat normals
+	if (primProcessing & MeshProcessingStepBits::GenerateFlatNormals) {
+		ProfileTimer timeFlatNormals;
+
+		const size_t faceCount = vertices.size() / 3;
+
+		for (size_t i = 0; i < faceCount; ++i) {
+			auto& v1     = vertices[i * 3 + 0];
+			auto& v2     = vertices[i * 3 + 1];
+			auto& v3     = vertices[i * 3 + 2];
+			const auto n = glm::normalize(glm::triangleNormal(v1.Position, v2.Position, v3.Position));
+
+			v1.Normal = n;
+			v2.Normal = n;
+			v3.Normal = n;
+		}
+
+		result.TimeGenerateFlatNormals += timeFlatNormals.Get();
+	}
+
+	// Pre-Processing: Generate tangent space
+	if (primProcessing & MeshProcessingStepBits::GenerateTangentSpace) {
+		ProfileTimer timeTangent;
+
+		// Each primitive gets its own MikkTSpace context, so that tangent generation can run on several threads at once.
+		MikkTContext context{vertices, material};
+		SMikkTSpaceContext mikktContext = {.m_pInterface = &MikkTInterface, .m_pUserData = &context};
+		genTangSpaceDefault(&mikktContext);
+
+		result.TimeGenerateTangents += timeTangent.Get();
+	}
+
+	// Pre-Processing: Weld vertices
+	if (primProcessing & MeshProcessingStepBits::WeldVertices) {
+		ProfileTimer timeWeld;
+
+		WeldVertices(vertices, indices, WeldTolerance);
+
+		result.TimeWeldVertices += timeWeld.Get();
+	}
+
+	// Calculate primitive bounding box.
+	for (const auto& v : vertices) {
+		result.BoundsMin = glm::min(v.Position, result.BoundsMin);
+		result.BoundsMax = glm::max(v.Position, result.BoundsMax);
+	}
+}
+
+// Statistics gathered while processing a single merged submesh.
+struct ProcessedSubmesh {
+	VertexCacheStats VertexCacheBefore;
+	VertexCacheStats VertexCacheAfter;
+	OverdrawStats OverdrawBefore;
+	OverdrawStats OverdrawAfter;
+	VertexFetchStats VertexFetchBefore;
+	VertexFetchStats VertexFetchAfter;
+	std::vector<Meshlet> Meshlets;
+	MeshletStats MeshletStats;
+	// The simplified levels of detail, with index ranges into LodIndices.
+	std::vector<GeometryCache::LodRecord> Lods;
+	std::vector<uint32_t> LodIndices;
+
+	double TimeOptimizeVertexCache = 0.0;
+	double TimeOptimizeOverdraw    = 0.0;
+	double TimeBuildMeshlets       = 0.0;
+	double TimeGenerateLods        = 0.0;
+	double TimeOptimizeVertexFetch = 0.0;
+};
+
+// Process one submesh once all of its primitives have been merged together. Indices are relative to the start of the
+// submesh's vertices, and packedVertexSize is the size each vertex will have on the GPU. Submeshes never share vertices
+// or indices, so any number of these can run concurrently.
+static void ProcessSubmesh(std::span<Vertex> vertices,
+                           std::span<uint32_t> indices,
+                           MeshProcessingSteps steps,
+                           size_t packedVertexSize,
+                           ProcessedSubmesh& result) {
+	if (indices.size() < 3) { return; }
+
+	// Analysis is kept out of the timers, so that they only measure the optimizations themselves. The "after" figures
+	// are taken once every step which reorders triangles has run, so that they describe the order the submesh is drawn
+	// with rather than the order one step left it in.
+	const float* positions = glm::value_ptr(vertices[0].Position);
+
+	// Post-Processing: Vertex cache optimization
+	if (steps & MeshProcessingStepBits::OptimizeVertexCache) {
+		result.VertexCacheBefore = AnalyzeVertexCache(indices, vertices.size());
+
+		ProfileTimer timeOptimize;
+		OptimizeVertexCache(indices, vertices.size());
+		result.TimeOptimizeVertexCache += timeOptimize.Get();
+	}
+
+	// Post-Processing: Overdraw optimization
+	if (steps & MeshProcessingStepBits::OptimizeOverdraw) {
+		result.OverdrawBefore = AnalyzeOverdraw(indices, positions, vertices.size(), sizeof(Vertex));
+
+		ProfileTimer timeOptimize;
+		OptimizeOverdraw(indices, positions, vertices.size(), sizeof(Vertex));
+		result.TimeOptimizeOverdraw += timeOptimize.Get();
+	}
+
+	// Post-Processing: Meshlets. This makes the triangles of each meshlet contiguous, so it must come after every step
+	// which chooses the order of the triangles.
+	if (steps & MeshProcessingStepBits::BuildMeshlets) {
+		ProfileTimer timeBuild;
+
+		result.Meshlets = BuildMeshlets(indices, positions, vertices.size(), sizeof(Vertex));
+		for (const auto& meshlet : result.Meshlets) {
+			result.MeshletStats.Meshlets++;
+			result.MeshletStats.Vertices += meshlet.VertexCount;
+			result.MeshletStats.Triangles += meshlet.IndexCount / 3;
+		}
+
+		result.TimeBuildMeshlets += timeBuild.Get();
+	}
+
+	// The triangles are now in their final order. Neither the levels of detail nor vertex fetch optimization change it:
+	// the latter only renumbers vertices, which affects neither figure.
+	if (steps & MeshProcessingStepBits::OptimizeVertexCache) {
+		result.VertexCacheAfter = AnalyzeVertexCache(indices, vertices.size());
+	}
+	if (steps & MeshProcessingStepBits::OptimizeOverdraw) {
+		result.OverdrawAfter = AnalyzeOverdraw(indices, positions, vertices.size(), sizeof(Vertex));
+	}
+
+	// Post-Processing: Levels of detail. Every level is simplified from the full submesh rather than from the level
+	// before it, so that its error is measured against the original surface.
+	if (steps & MeshProcessingStepBits::GenerateLods) {
+		ProfileTimer timeGenerate;
+
+		std::vector<uint32_t> lodIndices(indices.size());
+		size_t previousCount = indices.size();
+		while (result.Lods.size() < GeometryCache::MaxLods) {
+			const size_t targetCount = static_cast<size_t>(previousCount / 3 * LodReduction) * 3;
+			if (targetCount < LodMinTriangles * 3) { break; }
+
+			float error        = 0.0f;
+			const size_t count = SimplifyMesh(
+				lodIndices, indices, positions, vertices.size(), sizeof(Vertex), targetCount, LodMaxError, &error);
+			if (count == 0 || count > previousCount * LodMinReduction) { break; }
+
+			std::span<uint32_t> lod(lodIndices.data(), count);
+			if (steps & MeshProcessingStepBits::OptimizeVertexCache) { OptimizeVertexCache(lod, vertices.size()); }
+			result.Lods.push_back({.FirstIndex = result.LodIndices.size(), .IndexCount = count, .Error = error});
+			result.LodIndices.insert(result.LodIndices.end(), lod.begin(), lod.end());
+			previousCount = count;
+		}
+
+		result.TimeGenerateLods += timeGenerate.Get();
+	}
+
+	// Post-Processing: Vertex fetch optimization. This must come last, as it changes the order of the vertices.
+	if (steps & MeshProcessingStepBits::OptimizeVertexFetch) {
+		ProfileTimer timeOptimize;
+
+		result.VertexFetchBefore = AnalyzeVertexFetch(indices, vertices.size(), packedVertexSize);
+		if (result.LodIndices.empty()) {
+			OptimizeVertexFetch(indices, vertices.data(), vertices.size(), sizeof(Vertex));
+		} else {
+			// The levels of detail draw from the same vertices, so their indices must be rewritten along with the
+			// submesh's. They only use vertices the full submesh does, so the vertex order is decided by it alone.
+			std::vector<uint32_t> allIndices(indices.begin(), indices.end());
+			allIndices.insert(allIndices.end(), result.LodIndices.begin(), result.LodIndices.end());
+			OptimizeVertexFetch(allIndices, vertices.data(), vertices.size(), sizeof(Vertex));
+			std::copy(allIndices.begin(), allIndices.begin() + indices.size(), indices.begin());
+			std::copy(allIndices.begin() + indices.size(), allIndices.end(), result.LodIndices.begin());
+		}
+		result.VertexFetchAfter = AnalyzeVertexFetch(indices, vertices.size(), packedVertexSize);
+
+		result.TimeOptimizeVertexFetch += timeOptimize.Get();
+	}
+}
+
+void Model::ImportMeshes(const fastgltf::Asset& gltfModel, tk::Device* device) {
+	GeometryCache geometry;
+
+	// If this exact model has been processed before, we can skip straight to uploading the result.
+	const auto cachePath = GeometryCache::GetCachePath(_geometryKey);
+	if (UseGeometryCache) {
+		ProfileTimer cacheTimer;
+		_geometryCacheHit = geometry.Load(cachePath, _geometryKey, Materials.size()) &&
+		                    geometry.GetMeshes().size() == gltfModel.meshes.size();
+		_timeGeometryCache += cacheTimer.Get();
+	}
+
+	if (!_geometryCacheHit) {
+		geometry = BakeMeshes(gltfModel);
+
+		if (UseGeometryCache) {
+			ProfileTimer cacheTimer;
+			try {
+				geometry.Save(cachePath, _geometryKey);
+			} catch (const std::exception& e) {
+				std::cerr << "[GltfImporter] Failed to write geometry cache " << cachePath.string() << ": " << e.what()
+				          << std::endl;
+			}
+			_timeGeometryCache += cacheTimer.Get();
+		}
+	}
+
+	const auto meshRecords = geometry.GetMeshes();
+	for (size_t meshIndex = 0; meshIndex < meshRecords.size(); ++meshIndex) {
+		const auto& meshRecord = meshRecords[meshIndex];
+		const auto& gltfMesh   = gltfModel.meshes[meshIndex];
+		auto& mesh             = Meshes.emplace_back(new Mesh());
+		mesh->Id               = meshIndex;
+		mesh->Name             = "Mesh " + std::to_string(meshIndex);
+		if (!mesh->Name.empty()) { mesh->Name = gltfMesh.name; }
+
+		for (const auto& submeshRecord : geometry.GetSubmeshes(meshRecord)) {
+			auto& submesh        = mesh->Submeshes.emplace_back();
+			submesh.Material     = Materials[submeshRecord.Material].get();
+			submesh.VertexCount  = submeshRecord.VertexCount;
+			submesh.IndexCount   = submeshRecord.IndexCount;
+			submesh.FirstVertex  = submeshRecord.FirstVertex;
+			submesh.FirstIndex   = submeshRecord.FirstIndex;
+			submesh.FirstMeshlet = submeshRecord.FirstMeshlet;
+			submesh.MeshletCount = submeshRecord.MeshletCount;
+			submesh.Bounds       = BoundingBox(submeshRecord.BoundsMin, submeshRecord.BoundsMax);
+			submesh.Bounds.Valid = submeshRecord.BoundsValid;
+
+			if (submesh.IndexCount > 0) {
+				submesh.Lods.push_back({.FirstIndex = submesh.FirstIndex, .IndexCount = submesh.IndexCount});
+				for (uint32_t i = 0; i < submeshRecord.LodCount; ++i) {
+					const auto& lod = submeshRecord.Lods[i];
+					submesh.Lods.push_back({.FirstIndex = lod.FirstIndex, .IndexCount = lod.IndexCount, .Error = lod.Error});
+				}
+			}
+		}
+
+		mesh->Bounds           = BoundingBox(meshRecord.BoundsMin, meshRecord.BoundsMax);
+		mesh->Bounds.Valid     = meshRecord.BoundsValid;
+		mesh->IndexOffset      = meshRecord.IndexOffset;
+		mesh->TotalVertexCount = meshRecord.TotalVertexCount;
+		mesh->TotalIndexCount  = meshRecord.TotalIndexCount;
+
+		const bool shortIndices = meshRecord.IndexSize == sizeof(uint16_t);
+		mesh->IndexType         = shortIndices ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+		mesh->Index             = {.Format = shortIndices ? vk::Format::eR16Uint : vk::Format::eR32Uint,
+		                           .Offset = meshRecord.IndexOffset,
+		                           .Size   = meshRecord.IndexSize,
+		                           .Stride = meshRecord.IndexSize};
+
+		const auto vertexFormat =
+			GetPackedVertexFormat(PackedVertexLayout(meshRecord.VertexLayout), meshRecord.TotalVertexCount);
+
+		VertexAttribute* attributes[VertexInputCount] = {&mesh->Position,
+		                                                 &mesh->Normal,
+		                                                 &mesh->Tangent,
+		                                                 &mesh->Texcoord0,
+		                                                 &mesh->Texcoord1,
+		                                                 &mesh->Color0,
+		                                                 &mesh->Joints0,
+		                                                 &mesh->Weights0};
+		for (uint32_t i = 0; i < VertexInputCount; ++i) {
+			const auto& attribute = vertexFormat.Attributes[i];
+			if (attribute.Format == vk::Format::eUndefined) { continue; }
+
+			*attributes[i] = {
+				.Format = attribute.Format, .Offset = attribute.Offset, .Size = attribute.Size, .Stride = attribute.Stride};
+		}
+		_vertexDataSize += meshRecord.TotalVertexCount * vertexFormat.VertexSize;
+		_unpackedVertexDataSize += meshRecord.TotalVertexCount * sizeof(Vertex);
+		_indexDataSize += meshRecord.TotalIndexCount * meshRecord.IndexSize;
+		_unpackedIndexDataSize += meshRecord.TotalIndexCount * sizeof(uint32_t);
+
+		const auto* meshletData = geometry.GetMeshData(meshRecord) + meshRecord.MeshletOffset;
+		const auto* meshlets    = reinterpret_cast<const Meshlet*>(meshletData);
+		mesh->Meshlets.assign(meshlets, meshlets + meshRecord.MeshletCount);
+		mesh->MeshletOffset = meshRecord.MeshletOffset;
+
+		const tk::BufferCreateInfo bufferCI(tk::BufferDomain::Device,
+		                                    meshRecord.DataSize,
+		                                    vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer |
+		                                      vk::BufferUsageFlagBits::eStorageBuffer);
+		ProfileTimer uploadTimer;
+		if (_options.UploadData) { mesh->Buffer = device->CreateBuffer(bufferCI, geometry.GetMeshData(meshRecord)); }
+		const double uploadTime = uploadTimer.Get();
+		_timeMeshUpload += uploadTime;
+		_meshDataSize += meshRecord.DataSize;
+
+		// Meshes loaded from the geometry cache were processed by an earlier import, so only their upload is counted.
+		const double processTime = meshIndex < _meshProcessTimes.size() ? _meshProcessTimes[meshIndex] : 0.0;
+		std::string stageName    = std::string(gltfMesh.name);
+		if (stageName.empty()) { stageName = "Mesh " + std::to_string(meshIndex); }
+		_meshStages.emplace_back(stageName, processTime + uploadTime, meshRecord.DataSize, mesh->Submeshes.size());
+	}
+}
+
+GeometryCache Model::BakeMeshes(const fastgltf::Asset& gltfModel) {
+	// Every primitive is processed independently, so we first lay out all of the meshes and submeshes, recording which
+	// primitive belongs where. The primitives are then processed in parallel, and finally merged back into their meshes
+	// in the same order they were recorded in, so the output does not depend on how the work was scheduled.
+	struct PrimitiveTask {
+		size_t MeshIndex                     = 0;
+		size_t SubmeshIndex                  = 0;
+		const fastgltf::Primitive* Primitive = nullptr;
+		Material* Material                   = nullptr;
+	};
+	std::vector<PrimitiveTask> primitiveTasks;
+	std::vector<std::vector<uint32_t>> submeshMaterials(gltfModel.meshes.size());
 
 	for (size_t meshIndex = 0; meshIndex < gltfModel.meshes.size(); ++meshIndex) {
 		const auto& gltfMesh = gltfModel.meshes[meshIndex];
-		auto& mesh           = Meshes.emplace_back(new Mesh());
-		mesh->Id             = meshIndex;
-		mesh->Name           = "Mesh " + std::to_string(meshIndex);
-		if (!mesh->Name.empty()) { mesh->Name = gltfMesh.name; }
 
 		// Default material is always appended to the end of the glTF materials array.
 		const size_t defaultMaterialIndex = Materials.size() - 1;
 
 		// Sort all of our primitives by material.
-		std::vector<fastgltf::Primitive> gltfPrimitives = gltfMesh.primitives;
-		std::sort(gltfPrimitives.begin(),
-		          gltfPrimitives.end(),
-		          [defaultMaterialIndex](const fastgltf::Primitive& a, const fastgltf::Primitive& b) -> bool {
-								return a.materialIndex.value_or(defaultMaterialIndex) > b.materialIndex.value_or(defaultMaterialIndex);
-							});
+		std::vector<const fastgltf::Primitive*> gltfPrimitives;
+		gltfPrimitives.reserve(gltfMesh.primitives.size());
+		for (const auto& gltfPrimitive : gltfMesh.primitives) { gltfPrimitives.push_back(&gltfPrimitive); }
+		std::stable_sort(gltfPrimitives.begin(),
+		                 gltfPrimitives.end(),
+		                 [defaultMaterialIndex](const fastgltf::Primitive* a, const fastgltf::Primitive* b) -> bool {
+											 return a->materialIndex.value_or(defaultMaterialIndex) >
+											        b->materialIndex.value_or(defaultMaterialIndex);
+										 });
 
 		// Determine how many materials we're going to have, based on whether or not we're merging by material.
 		std::vector<std::vector<int>> materialPrimitives;  // One entry per material, with a list of primitives.
@@ -839,8 +2032,8 @@ void Model::ImportMeshes(const fastgltf::Asset& gltfModel, tk::Device& device) {
 			// Determine exactly which primitives belong to each material.
 			materialPrimitives.resize(Materials.size());
 			for (uint32_t i = 0; i < gltfPrimitives.size(); ++i) {
-				const auto& gltfPrimitive = gltfPrimitives[i];
-				materialPrimitives[gltfPrimitive.materialIndex.value_or(defaultMaterialIndex)].push_back(i);
+				const auto* gltfPrimitive = gltfPrimitives[i];
+				materialPrimitives[gltfPrimitive->materialIndex.value_or(defaultMaterialIndex)].push_back(i);
 			}
 
 			// Prune materials with no primitives from our list.
@@ -856,20 +2049,63 @@ void Model::ImportMeshes(const fastgltf::Asset& gltfModel, tk::Device& device) {
 			for (uint32_t i = 0; i < gltfPrimitives.size(); ++i) { materialPrimitives[i].push_back(i); }
 		}
 
-		// Start keeping track of how many vertices and indices we've created. We will need to use these when drawing later.
-		std::vector<Vertex> meshVertices;
-		std::vector<uint32_t> meshIndices;
-
 		for (size_t materialIndex = 0; materialIndex < materialPrimitives.size(); ++materialIndex) {
 			const auto& primitiveList = materialPrimitives[materialIndex];
-			auto& submesh             = mesh->Submeshes.emplace_back();
 
 			// Since all primitives within the submesh share a material, we simply take the material value from the first
 			// primitive.
-			const size_t gltfMaterialIndex = gltfPrimitives[primitiveList[0]].materialIndex.value_or(defaultMaterialIndex);
-			submesh.Material               = Materials[gltfMaterialIndex].get();
+			const size_t gltfMaterialIndex = gltfPrimitives[primitiveList[0]]->materialIndex.value_or(defaultMaterialIndex);
+			submeshMaterials[meshIndex].push_back(gltfMaterialIndex);
+
+			for (const auto gltfPrimitiveIndex : primitiveList) {
+				primitiveTasks.push_back({.MeshIndex    = meshIndex,
+				                          .SubmeshIndex = materialIndex,
+				                          .Primitive    = gltfPrimitives[gltfPrimitiveIndex],
+				                          .Material     = Materials[gltfMaterialIndex].get()});
+			}
+		}
+	}
+
+	// Process every primitive of every mesh across all available threads. How long each one took is summed per mesh for
+	// the load profile.
+	_meshProcessTimes.assign(gltfModel.meshes.size(), 0.0);
+	std::vector<ProcessedPrimitive> processedPrimitives(primitiveTasks.size());
+	std::vector<double> primitiveTimes(primitiveTasks.size());
+	ThreadPool::Get().ParallelFor(primitiveTasks.size(), [&](size_t i) {
+		ProfileTimer timer;
+		const auto& task = primitiveTasks[i];
+		ProcessPrimitive(gltfModel, _buffers, *task.Primitive, task.Material, processedPrimitives[i]);
+		primitiveTimes[i] = timer.Get();
+	});
+	for (size_t i = 0; i < primitiveTasks.size(); ++i) {
+		_meshProcessTimes[primitiveTasks[i].MeshIndex] += primitiveTimes[i];
+	}
+
+	// Merge the processed primitives into their meshes. Tasks were recorded mesh by mesh and submesh by submesh, so a
+	// single walk over them visits everything in order.
+	struct MergedMesh {
+		std::vector<Vertex> Vertices;
+		std::vector<uint32_t> Indices;
+		std::vector<GeometryCache::SubmeshRecord> Submeshes;
+		std::vector<MeshProcessingSteps> SubmeshSteps;
+		PackedVertexLayout Layout;
+	};
+	std::vector<MergedMesh> mergedMeshes(gltfModel.meshes.size());
+	size_t taskIndex = 0;
+	for (size_t meshIndex = 0; meshIndex < gltfModel.meshes.size(); ++meshIndex) {
+		// Start keeping track of how many vertices and indices we've created. We will need to use these when drawing later.
+		auto& merged       = mergedMeshes[meshIndex];
+		auto& meshVertices = merged.Vertices;
+		auto& meshIndices  = merged.Indices;
+		auto& submeshes    = merged.Submeshes;
+		submeshes.resize(submeshMaterials[meshIndex].size());
+		merged.SubmeshSteps.resize(submeshes.size());
+
+		for (size_t submeshIndex = 0; submeshIndex < submeshes.size(); ++submeshIndex) {
+			auto& submesh = submeshes[submeshIndex];
 
 			// Assign the submesh's starting offset.
+			submesh.Material    = submeshMaterials[meshIndex][submeshIndex];
 			submesh.FirstVertex = meshVertices.size();
 			submesh.FirstIndex  = meshIndices.size();
 			submesh.VertexCount = 0;
@@ -878,142 +2114,22 @@ void Model::ImportMeshes(const fastgltf::Asset& gltfModel, tk::Device& device) {
 			glm::vec3 boundsMin(std::numeric_limits<float>::max());
 			glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
 
-			for (const auto gltfPrimitiveIndex : primitiveList) {
-				const auto& gltfPrimitive = gltfPrimitives[gltfPrimitiveIndex];
-				const auto primAttributes = GetAvailableAttributes(gltfPrimitive);
-				const auto primProcessing = GetProcessingSteps(primAttributes);
-
-				// Verify we have position data.
-				if (!(primAttributes & VertexAttributeBits::Position)) { continue; }
-
-				std::vector<Vertex> vertices;
-				std::vector<uint32_t> indices;
-
-				// Load the geometry data.
-				{
-					ProfileTimer loadVertices;
-
-					auto positions  = GetAccessorData<glm::vec3>(gltfModel, gltfPrimitive, VertexAttributeBits::Position);
-					auto normals    = GetAccessorData<glm::vec3>(gltfModel, gltfPrimitive, VertexAttributeBits::Normal);
-					auto tangents   = GetAccessorData<glm::vec4>(gltfModel, gltfPrimitive, VertexAttributeBits::Tangent);
-					auto texcoords0 = GetAccessorData<glm::vec2>(gltfModel, gltfPrimitive, VertexAttributeBits::Texcoord0);
-					auto texcoords1 = GetAccessorData<glm::vec2>(gltfModel, gltfPrimitive, VertexAttributeBits::Texcoord1);
-					auto colors0    = GetAccessorData<glm::vec4>(gltfModel, gltfPrimitive, VertexAttributeBits::Color0);
-					if (colors0.empty()) {
-						auto colors0v3 = GetAccessorData<glm::vec3>(gltfModel, gltfPrimitive, VertexAttributeBits::Color0);
-						if (!colors0v3.empty()) {
-							colors0.reserve(colors0v3.size());
-							for (const auto& c : colors0v3) { colors0.push_back(glm::vec4(c, 1.0f)); }
-						}
-					}
-					auto joints0  = GetAccessorData<glm::uvec4>(gltfModel, gltfPrimitive, VertexAttributeBits::Joints0);
-					auto weights0 = GetAccessorData<glm::vec4>(gltfModel, gltfPrimitive, VertexAttributeBits::Weights0);
-
-					normals.resize(positions.size());
-					tangents.resize(positions.size());
-					texcoords0.resize(positions.size());
-					texcoords1.resize(positions.size());
-					colors0.resize(positions.size(), glm::vec4(1, 1, 1, 1));
-					joints0.resize(positions.size());
-					weights0.resize(positions.size());
-
-					vertices.reserve(positions.size());
-					for (size_t i = 0; i < positions.size(); ++i) {
-						vertices.push_back(Vertex{.Position  = positions[i],
-						                          .Normal    = normals[i],
-						                          .Tangent   = tangents[i],
-						                          .Texcoord0 = texcoords0[i],
-						                          .Texcoord1 = texcoords1[i],
-						                          .Color0    = colors0[i],
-						                          .Joints0   = joints0[i],
-						                          .Weights0  = weights0[i]});
-					}
-
-					indices = GetAccessorData<uint32_t>(gltfModel, gltfPrimitive, VertexAttributeBits::Index);
-
-					_timeVertexLoad += loadVertices.Get();
-				}
-
-				// Pre-Processing: Unpack vertices
-				if (primProcessing & MeshProcessingStepBits::UnpackVertices) {
-					ProfileTimer timeUnpack;
-
-					if (indices.size() > 0) {
-						std::vector<Vertex> newVertices(indices.size());
-
-						uint32_t newIndex = 0;
-						for (const uint32_t index : indices) { newVertices[newIndex++] = vertices[index]; }
-						vertices = std::move(newVertices);
-						indices.clear();
-					}
-
-					_timeUnpackVertices += timeUnpack.Get();
-				}
-
-				// Pre-Processing: Flat normals
-				if (primProcessing & MeshProcessingStepBits::GenerateFlatNormals) {
-					ProfileTimer timeFlatNormals;
-
-					const size_t faceCount = vertices.size() / 3;
-
-					for (size_t i = 0; i < faceCount; ++i) {
-						auto& v1     = vertices[i * 3 + 0];
-						auto& v2     = vertices[i * 3 + 1];
-						auto& v3     = vertices[i * 3 + 2];
-						const auto n = glm::normalize(glm::triangleNormal(v1.Position, v2.Position, v3.Position));
-
-						v1.Normal = n;
-						v2.Normal = n;
-						v3.Normal = n;
-					}
-
-					_timeGenerateFlatNormals += timeFlatNormals.Get();
-				}
-
-				// Pre-Processing: Generate tangent space
-				if (primProcessing & MeshProcessingStepBits::GenerateTangentSpace) {
-					ProfileTimer timeTangent;
-
-					MikkTContext context{vertices, submesh.Material};
-					mikktContext.m_pUserData = &context;
-					genTangSpaceDefault(&mikktContext);
-
-					_timeGenerateTangents += timeTangent.Get();
-				}
+			for (; taskIndex < primitiveTasks.size() && primitiveTasks[taskIndex].MeshIndex == meshIndex &&
+			       primitiveTasks[taskIndex].SubmeshIndex == submeshIndex;
+			     ++taskIndex) {
+				auto& primitive = processedPrimitives[taskIndex];
+				auto& vertices  = primitive.Vertices;
+				auto& indices   = primitive.Indices;
 
-				// Pre-Processing: Weld vertices
-				if (primProcessing & MeshProcessingStepBits::WeldVertices) {
-					ProfileTimer timeWeld;
-
-					indices.clear();
-					indices.reserve(vertices.size());
-					std::unordered_map<Vertex, uint32_t> uniqueVertices;
-
-					const size_t oldVertexCount = vertices.size();
-					uint32_t newVertexCount     = 0;
-					for (size_t i = 0; i < oldVertexCount; ++i) {
-						const Vertex& v = vertices[i];
-
-						const auto it = uniqueVertices.find(v);
-						if (it == uniqueVertices.end()) {
-							const uint32_t index = newVertexCount++;
-							uniqueVertices.insert(std::make_pair(v, index));
-							vertices[index] = v;
-							indices.push_back(index);
-						} else {
-							indices.push_back(it->second);
-						}
-					}
-					vertices.resize(newVertexCount);
-
-					_timeWeldVertices += timeWeld.Get();
-				}
+				_timeVertexLoad += primitive.TimeVertexLoad;
+				_timeUnpackVertices += primitive.TimeUnpackVertices;
+				_timeGenerateFlatNormals += primitive.TimeGenerateFlatNormals;
+				_timeGenerateTangents += primitive.TimeGenerateTangents;
+				_timeWeldVertices += primitive.TimeWeldVertices;
 
-				// Calculate primitive bounding box.
-				for (const auto& v : vertices) {
-					boundsMin = glm::min(v.Position, boundsMin);
-					boundsMax = glm::max(v.Position, boundsMax);
-				}
+				merged.SubmeshSteps[submeshIndex] |= primitive.Steps;
+				boundsMin = glm::min(primitive.BoundsMin, boundsMin);
+				boundsMax = glm::max(primitive.BoundsMax, boundsMax);
 
 				// Post-processing: Offset indices
 				for (auto& i : indices) { i += submesh.VertexCount; }
@@ -1026,35 +2142,144 @@ void Model::ImportMeshes(const fastgltf::Asset& gltfModel, tk::Device& device) {
 
 				submesh.VertexCount += vertices.size();
 				submesh.IndexCount += indices.size();
+
+				// Release the primitive's memory as soon as it has been merged.
+				primitive = {};
 			}
 
-			submesh.Bounds       = BoundingBox(boundsMin, boundsMax);
-			submesh.Bounds.Valid = true;
+			const BoundingBox bounds(boundsMin, boundsMax);
+			submesh.BoundsMin   = bounds.Min;
+			submesh.BoundsMax   = bounds.Max;
+			submesh.BoundsValid = 1;
+		}
+
+		merged.Layout = ChoosePackedVertexLayout(meshVertices);
+		if (DeinterleaveVertices) { merged.Layout |= PackedVertexLayoutBits::Deinterleaved; }
+	}
+
+	// Run the processing steps which need a whole submesh at once, again across all available threads.
+	std::vector<std::pair<size_t, size_t>> submeshTasks;
+	for (size_t meshIndex = 0; meshIndex < mergedMeshes.size(); ++meshIndex) {
+		for (size_t submeshIndex = 0; submeshIndex < mergedMeshes[meshIndex].Submeshes.size(); ++submeshIndex) {
+			submeshTasks.emplace_back(meshIndex, submeshIndex);
+		}
+	}
+	std::vector<ProcessedSubmesh> processedSubmeshes(submeshTasks.size());
+	std::vector<double> submeshTimes(submeshTasks.size());
+	ThreadPool::Get().ParallelFor(submeshTasks.size(), [&](size_t i) {
+		ProfileTimer timer;
+		auto& merged        = mergedMeshes[submeshTasks[i].first];
+		const size_t index  = submeshTasks[i].second;
+		const auto& submesh = merged.Submeshes[index];
+		std::span<Vertex> vertices(merged.Vertices.data() + submesh.FirstVertex, submesh.VertexCount);
+		std::span<uint32_t> indices(merged.Indices.data() + submesh.FirstIndex, submesh.IndexCount);
+		const size_t vertexSize = GetPackedVertexFormat(merged.Layout, merged.Vertices.size()).VertexSize;
+		ProcessSubmesh(vertices, indices, merged.SubmeshSteps[index], vertexSize, processedSubmeshes[i]);
+		submeshTimes[i] = timer.Get();
+	});
+	for (size_t i = 0; i < submeshTasks.size(); ++i) { _meshProcessTimes[submeshTasks[i].first] += submeshTimes[i]; }
+	for (const auto& submesh : processedSubmeshes) {
+		_timeOptimizeVertexCache += submesh.TimeOptimizeVertexCache;
+		_vertexCacheBefore += submesh.VertexCacheBefore;
+		_vertexCacheAfter += submesh.VertexCacheAfter;
+		_timeOptimizeOverdraw += submesh.TimeOptimizeOverdraw;
+		_overdrawBefore += submesh.OverdrawBefore;
+		_overdrawAfter += submesh.OverdrawAfter;
+		_timeBuildMeshlets += submesh.TimeBuildMeshlets;
+		_meshletStats += submesh.MeshletStats;
+		_timeGenerateLods += submesh.TimeGenerateLods;
+		_lodCount += submesh.Lods.size();
+		_lodIndexCount += submesh.LodIndices.size();
+		_timeOptimizeVertexFetch += submesh.TimeOptimizeVertexFetch;
+		_vertexFetchBefore += submesh.VertexFetchBefore;
+		_vertexFetchAfter += submesh.VertexFetchAfter;
+	}
+
+	GeometryCache geometry;
+	size_t submeshTaskIndex = 0;
+	for (size_t meshIndex = 0; meshIndex < mergedMeshes.size(); ++meshIndex) {
+		auto& merged             = mergedMeshes[meshIndex];
+		const auto& meshVertices = merged.Vertices;
+		auto& meshIndices        = merged.Indices;
+		auto& submeshes          = merged.Submeshes;
+
+		// Gather the meshlets of every submesh into one list for the whole mesh, and append the indices of every submesh's
+		// levels of detail after those of the full submeshes.
+		std::vector<Meshlet> meshlets;
+		for (auto& submesh : submeshes) {
+			auto& processed      = processedSubmeshes[submeshTaskIndex++];
+			submesh.FirstMeshlet = meshlets.size();
+			submesh.MeshletCount = processed.Meshlets.size();
+			meshlets.insert(meshlets.end(), processed.Meshlets.begin(), processed.Meshlets.end());
+			processed.Meshlets = {};
+
+			submesh.LodCount = processed.Lods.size();
+			for (uint32_t i = 0; i < submesh.LodCount; ++i) {
+				submesh.Lods[i] = processed.Lods[i];
+				submesh.Lods[i].FirstIndex += meshIndices.size();
+			}
+			meshIndices.insert(meshIndices.end(), processed.LodIndices.begin(), processed.LodIndices.end());
+			processed.LodIndices = {};
 		}
 
-		mesh->TotalVertexCount = meshVertices.size();
-		mesh->TotalIndexCount  = meshIndices.size();
+		GeometryCache::MeshRecord mesh = {.TotalVertexCount = meshVertices.size(), .TotalIndexCount = meshIndices.size()};
 
-		for (const auto& submesh : mesh->Submeshes) {
-			if (submesh.Bounds.Valid && !mesh->Bounds.Valid) {
-				mesh->Bounds       = submesh.Bounds;
-				mesh->Bounds.Valid = true;
+		BoundingBox meshBounds;
+		for (const auto& submesh : submeshes) {
+			if (!submesh.BoundsValid) { continue; }
+			if (!meshBounds.Valid) {
+				meshBounds       = BoundingBox(submesh.BoundsMin, submesh.BoundsMax);
+				meshBounds.Valid = true;
 			}
-			mesh->Bounds.Min = glm::min(mesh->Bounds.Min, submesh.Bounds.Min);
-			mesh->Bounds.Max = glm::min(mesh->Bounds.Max, submesh.Bounds.Max);
+			meshBounds.Min = glm::min(meshBounds.Min, submesh.BoundsMin);
+			meshBounds.Max = glm::max(meshBounds.Max, submesh.BoundsMax);
 		}
+		mesh.BoundsMin   = meshBounds.Min;
+		mesh.BoundsMax   = meshBounds.Max;
+		mesh.BoundsValid = meshBounds.Valid;
 
-		const vk::DeviceSize vertexSize = meshVertices.size() * sizeof(Vertex);
-		const vk::DeviceSize indexSize  = meshIndices.size() * sizeof(uint32_t);
-		std::vector<uint8_t> bufferData(vertexSize + indexSize);
-		memcpy(bufferData.data(), meshVertices.data(), vertexSize);
-		memcpy(bufferData.data() + vertexSize, meshIndices.data(), indexSize);
-		mesh->IndexOffset = vertexSize;
-		const tk::BufferCreateInfo bufferCI(tk::BufferDomain::Device,
-		                                    vertexSize + indexSize,
-		                                    vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer);
-		mesh->Buffer = device.CreateBuffer(bufferCI, bufferData.data());
+		const vk::DeviceSize vertexSize =
+			meshVertices.size() * GetPackedVertexFormat(merged.Layout, meshVertices.size()).VertexSize;
+
+		bool shortIndices = ShortIndices;
+		for (const auto& submesh : submeshes) {
+			if (submesh.VertexCount > MaxShortIndexVertices) { shortIndices = false; }
+		}
+		const size_t indexStride       = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+		const vk::DeviceSize indexSize = meshIndices.size() * indexStride;
+
+		const vk::DeviceSize meshletOffset =
+			(vertexSize + indexSize + MeshletAlignment - 1) / MeshletAlignment * MeshletAlignment;
+		const vk::DeviceSize meshletSize = meshlets.size() * sizeof(Meshlet);
+
+		std::vector<uint8_t> bufferData(meshlets.empty() ? vertexSize + indexSize : meshletOffset + meshletSize);
+		{
+			ProfileTimer timePack;
+			PackVertices(meshVertices, merged.Layout, bufferData.data());
+			const double time = timePack.Get();
+			_timePackVertices += time;
+			_meshProcessTimes[meshIndex] += time;
+		}
+		// Packed vertices are always a multiple of 4 bytes, so the indices that follow are suitably aligned.
+		if (shortIndices) {
+			uint16_t* shortIndexData = reinterpret_cast<uint16_t*>(bufferData.data() + vertexSize);
+			for (size_t i = 0; i < meshIndices.size(); ++i) { shortIndexData[i] = static_cast<uint16_t>(meshIndices[i]); }
+		} else {
+			memcpy(bufferData.data() + vertexSize, meshIndices.data(), indexSize);
+		}
+		if (!meshlets.empty()) { memcpy(bufferData.data() + meshletOffset, meshlets.data(), meshletSize); }
+		mesh.IndexOffset   = vertexSize;
+		mesh.VertexLayout  = merged.Layout.Value;
+		mesh.IndexSize     = indexStride;
+		mesh.MeshletOffset = meshletOffset;
+		mesh.MeshletCount  = meshlets.size();
+		geometry.AddMesh(mesh, submeshes, bufferData.data(), bufferData.size());
+
+		// Release the merged mesh's memory as soon as it has been stored.
+		merged = {};
 	}
+
+	return geometry;
 }
 
 void Model::ImportNodes(const fastgltf::Asset& gltfModel) {
@@ -1092,9 +2317,36 @@ void Model::ImportNodes(const fastgltf::Asset& gltfModel) {
 	}
 
 	for (const auto node : gltfScene.nodeIndices) { RootNodes.push_back(_nodes[node].get()); }
+
+	// Lay the transforms out breadth first from every node without a parent, which puts each node after its parent.
+	// Nodes outside of the scene are included too, as skins and animations may still refer to them.
+	_transformNodes.reserve(_nodes.size());
+	_transformParents.reserve(_nodes.size());
+	for (auto& node : _nodes) {
+		if (node->Parent) { continue; }
+		node->TransformIndex = _transformNodes.size();
+		_transformNodes.push_back(node.get());
+		_transformParents.push_back(-1);
+	}
+	for (size_t i = 0; i < _transformNodes.size(); ++i) {
+		for (auto* child : _transformNodes[i]->Children) {
+			child->TransformIndex = _transformNodes.size();
+			_transformNodes.push_back(child);
+			_transformParents.push_back(static_cast<int32_t>(i));
+		}
+	}
+	_transformChanged.resize(_transformNodes.size());
+	_localTransforms.resize(_transformNodes.size());
+	_worldTransforms.resize(_transformNodes.size());
+	_animLocalTransforms.resize(_transformNodes.size());
+	_animWorldTransforms.resize(_transformNodes.size());
 }
 
-void Model::ImportSamplers(const fastgltf::Asset& gltfModel, tk::Device& device) {
+void Model::ImportSamplers(const fastgltf::Asset& gltfModel, tk::Device* device) {
+	// Without a device, samplers are described but never requested.
+	const bool anisotropy     = device && device->GetGPUInfo().EnabledFeatures.Features.samplerAnisotropy;
+	const float maxAnisotropy = device ? device->GetGPUInfo().Properties.Properties.limits.maxSamplerAnisotropy : 1.0f;
+
 	for (size_t i = 0; i < gltfModel.samplers.size(); ++i) {
 		const auto& gltfSampler = gltfModel.samplers[i];
 		auto& sampler           = Samplers.emplace_back(std::make_shared<Sampler>());
@@ -1105,8 +2357,8 @@ void Model::ImportSamplers(const fastgltf::Asset& gltfModel, tk::Device& device)
 			.MipmapMode       = vk::SamplerMipmapMode::eNearest,
 			.AddressModeU     = vk::SamplerAddressMode::eRepeat,
 			.AddressModeV     = vk::SamplerAddressMode::eRepeat,
-			.AnisotropyEnable = device.GetGPUInfo().EnabledFeatures.Features.samplerAnisotropy,
-			.MaxAnisotropy    = device.GetGPUInfo().Properties.Properties.limits.maxSamplerAnisotropy,
+			.AnisotropyEnable = anisotropy,
+			.MaxAnisotropy    = maxAnisotropy,
 			.MinLod           = 0.0f,
 			.MaxLod           = 16.0f};
 
@@ -1186,7 +2438,7 @@ void Model::ImportSamplers(const fastgltf::Asset& gltfModel, tk::Device& device)
 				break;
 		}
 
-		sampler->Sampler = device.RequestSampler(samplerCI);
+		if (device) { sampler->Sampler = device->RequestSampler(samplerCI); }
 	}
 
 	_defaultSampler = Samplers.emplace_back(new Sampler()).get();
@@ -1196,14 +2448,14 @@ void Model::ImportSamplers(const fastgltf::Asset& gltfModel, tk::Device& device)
 		.MipmapMode       = vk::SamplerMipmapMode::eNearest,
 		.AddressModeU     = vk::SamplerAddressMode::eRepeat,
 		.AddressModeV     = vk::SamplerAddressMode::eRepeat,
-		.AnisotropyEnable = device.GetGPUInfo().EnabledFeatures.Features.samplerAnisotropy,
-		.MaxAnisotropy    = device.GetGPUInfo().Properties.Properties.limits.maxSamplerAnisotropy,
+		.AnisotropyEnable = anisotropy,
+		.MaxAnisotropy    = maxAnisotropy,
 		.MinLod           = 0.0f,
 		.MaxLod           = 16.0f};
-	_defaultSampler->Sampler = device.RequestSampler(samplerCI);
+	if (device) { _defaultSampler->Sampler = device->RequestSampler(samplerCI); }
 }
 
-void Model::ImportSkins(const fastgltf::Asset& gltfModel, tk::Device& device) {
+void Model::ImportSkins(const fastgltf::Asset& gltfModel, tk::Device* device) {
 	for (size_t i = 0; i < gltfModel.skins.size(); ++i) {
 		const auto& gltfSkin = gltfModel.skins[i];
 		auto& skin           = Skins.emplace_back(std::make_shared<Skin>());
@@ -1211,18 +2463,18 @@ void Model::ImportSkins(const fastgltf::Asset& gltfModel, tk::Device& device) {
 		skin->RootNode = _nodes[gltfSkin.skeleton.value()].get();
 		for (auto j : gltfSkin.joints) { skin->Joints.push_back(_nodes[j].get()); }
 		if (gltfSkin.inverseBindMatrices) {
-			const auto& gltfAccessor   = gltfModel.accessors[gltfSkin.inverseBindMatrices.value()];
-			const auto& gltfBufferView = gltfModel.bufferViews[gltfAccessor.bufferViewIndex.value()];
-			const auto& gltfBuffer     = gltfModel.buffers[gltfBufferView.bufferIndex];
+			const auto& gltfAccessor = gltfModel.accessors[gltfSkin.inverseBindMatrices.value()];
 			const glm::mat4* matrices =
-				reinterpret_cast<const glm::mat4*>(&gltfBuffer.data.bytes[gltfAccessor.byteOffset + gltfBufferView.byteOffset]);
+				reinterpret_cast<const glm::mat4*>(GetAccessorBytes(gltfModel, _buffers, gltfAccessor));
 			skin->InverseBindMatrices.resize(gltfAccessor.count);
 			memcpy(skin->InverseBindMatrices.data(), matrices, gltfAccessor.count * sizeof(glm::mat4));
 
-			skin->Buffer = device.CreateBuffer(
-				tk::BufferCreateInfo(
-					tk::BufferDomain::Host, gltfAccessor.count * sizeof(glm::mat4), vk::BufferUsageFlagBits::eStorageBuffer),
-				skin->InverseBindMatrices.data());
+			if (_options.UploadData) {
+				skin->Buffer = device->CreateBuffer(
+					tk::BufferCreateInfo(
+						tk::BufferDomain::Host, gltfAccessor.count * sizeof(glm::mat4), vk::BufferUsageFlagBits::eStorageBuffer),
+					skin->InverseBindMatrices.data());
+			}
 		}
 	}
 }
@@ -1232,7 +2484,7 @@ void Model::ImportTextures(const fastgltf::Asset& gltfModel) {
 		const auto& gltfTexture = gltfModel.textures[i];
 		auto& texture           = Textures.emplace_back(std::make_shared<Texture>());
 
-		texture->Image = Images[gltfTexture.imageIndex.value()].get();
+		texture->Image = Images[_textureImages[i]].get();
 		if (gltfTexture.samplerIndex) {
 			texture->Sampler = Samplers[gltfTexture.samplerIndex.value()].get();
 		} else {
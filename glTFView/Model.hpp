@@ -1,14 +1,27 @@
 #pragma once
 
 #include <Tsuki/Common.hpp>
+#include <Tsuki/EnumClass.hpp>
+#include <Tsuki/Hash.hpp>
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "AnimationCompression.hpp"
+#include "Files.hpp"
+#include "Keyframes.hpp"
+#include "LoadProfile.hpp"
+#include "MeshOptimizer.hpp"
+#include "Meshlets.hpp"
+
+class GeometryCache;
+
 namespace fastgltf {
 class Asset;
 class Mesh;
@@ -72,22 +85,6 @@ struct Vertex {
 	}
 };
 
-template <>
-struct std::hash<Vertex> {
-	size_t operator()(const Vertex& data) const {
-		tk::Hasher h;
-		h.Data(sizeof(data.Position), glm::value_ptr(data.Position));
-		h.Data(sizeof(data.Normal), glm::value_ptr(data.Normal));
-		h.Data(sizeof(data.Tangent), glm::value_ptr(data.Tangent));
-		h.Data(sizeof(data.Texcoord0), glm::value_ptr(data.Texcoord0));
-		h.Data(sizeof(data.Texcoord1), glm::value_ptr(data.Texcoord1));
-		h.Data(sizeof(data.Color0), glm::value_ptr(data.Color0));
-		h.Data(sizeof(data.Joints0), glm::value_ptr(data.Joints0));
-		h.Data(sizeof(data.Weights0), glm::value_ptr(data.Weights0));
-		return static_cast<size_t>(h.Get());
-	}
-};
-
 struct Image {
 	vk::Format Format;
 	tk::ImageHandle Image;
@@ -95,7 +92,7 @@ struct Image {
 };
 
 struct Sampler {
-	tk::Sampler* Sampler;
+	tk::Sampler* Sampler = nullptr;
 };
 
 struct Texture {
@@ -164,6 +161,8 @@ struct Material {
 	void Update(tk::Device& device) const;
 
 	std::string Name;
+	// Whether Update may create the material's data buffer. Cleared for materials of models loaded without UploadData.
+	bool UploadData = true;
 	glm::vec4 BaseColorFactor = glm::vec4(1, 1, 1, 1);
 	glm::vec3 EmissiveFactor  = glm::vec3(0, 0, 0);
 	std::shared_ptr<Texture> Albedo;
@@ -193,19 +192,37 @@ struct Material {
 	mutable tk::Hash DataHash = {};
 };
 
+// One level of detail of a submesh: a range of its mesh's index buffer which draws the same vertices with fewer
+// triangles. Error is how far the simplified surface strays from the original, relative to the size of the submesh's
+// bounds.
+struct SubmeshLod {
+	vk::DeviceSize FirstIndex = 0;
+	vk::DeviceSize IndexCount = 0;
+	float Error               = 0.0f;
+};
+
 struct Submesh {
 	Material* Material         = nullptr;
 	vk::DeviceSize VertexCount = 0;
 	vk::DeviceSize IndexCount  = 0;
 	vk::DeviceSize FirstVertex = 0;
 	vk::DeviceSize FirstIndex  = 0;
+	uint32_t FirstMeshlet      = 0;
+	uint32_t MeshletCount      = 0;
 	BoundingBox Bounds;
+	// From most to least detailed. The first level is always the full submesh, and meshlets only apply to it. Empty for
+	// submeshes without indices.
+	std::vector<SubmeshLod> Lods;
 };
 
+// Where one vertex input lives within a mesh's buffer. Offset is the byte offset of the first vertex's value, Size is
+// the size of one value and Stride is the distance between consecutive values. Inputs the mesh does not store have an
+// undefined format.
 struct VertexAttribute {
-	vk::DeviceSize Offset;
-	vk::DeviceSize Size;
-	vk::DeviceSize Stride;
+	vk::Format Format     = vk::Format::eUndefined;
+	vk::DeviceSize Offset = 0;
+	vk::DeviceSize Size   = 0;
+	vk::DeviceSize Stride = 0;
 };
 
 struct Mesh {
@@ -220,22 +237,28 @@ struct Mesh {
 	VertexAttribute Tangent;
 	VertexAttribute Bitangent;
 	VertexAttribute Texcoord0;
+	VertexAttribute Texcoord1;
+	VertexAttribute Color0;
 	VertexAttribute Joints0;
 	VertexAttribute Weights0;
 	VertexAttribute Index;
 
-	vk::DeviceSize PositionOffset   = 0;
-	vk::DeviceSize NormalOffset     = 0;
-	vk::DeviceSize TangentOffset    = 0;
-	vk::DeviceSize BitangentOffset  = 0;
-	vk::DeviceSize Texcoord0Offset  = 0;
-	vk::DeviceSize Joints0Offset    = 0;
-	vk::DeviceSize Weights0Offset   = 0;
 	vk::DeviceSize IndexOffset      = 0;
+	vk::IndexType IndexType         = vk::IndexType::eUint32;
 	vk::DeviceSize TotalVertexCount = 0;
 	vk::DeviceSize TotalIndexCount  = 0;
+
+	// The meshlets of every submesh. They are also stored in Buffer, starting at MeshletOffset.
+	std::vector<Meshlet> Meshlets;
+	vk::DeviceSize MeshletOffset = 0;
 };
 
+// Which of a node's local transforms have changed since the model last updated its world transforms.
+enum class NodeDirtyBits : uint8_t { Rest = 1 << 0, Anim = 1 << 1 };
+using NodeDirtyFlags = tk::Bitmask<NodeDirtyBits>;
+template <>
+struct tk::EnableBitmaskOperators<NodeDirtyBits> : std::true_type {};
+
 struct Node {
 	std::string Name;
 	Node* Parent = nullptr;
@@ -245,6 +268,8 @@ struct Node {
 	BoundingBox AABB;
 	BoundingBox BVH;
 
+	// The node's rest and animated local transforms. Once the model has loaded, these must be changed through the
+	// setters below, so that the model knows which world transforms to recompute.
 	glm::vec3 Translation = glm::vec3(0.0f);
 	glm::quat Rotation    = glm::quat();
 	glm::vec3 Scale       = glm::vec3(1.0f);
@@ -253,39 +278,47 @@ struct Node {
 	glm::quat AnimRotation    = glm::quat();
 	glm::vec3 AnimScale       = glm::vec3(1.0f);
 
+	// Where the node's transforms are stored in its model's transform arrays.
+	uint32_t TransformIndex   = 0;
+	NodeDirtyFlags DirtyFlags = NodeDirtyBits::Rest | NodeDirtyBits::Anim;
+
 	glm::mat4 GetLocalTransform() const {
 		return glm::translate(glm::mat4(1.0f), Translation) * glm::mat4(Rotation) * glm::scale(glm::mat4(1.0f), Scale);
 	}
-	glm::mat4 GetGlobalTransform() const {
-		glm::mat4 matrix = GetLocalTransform();
-
-		Node* parent = Parent;
-		while (parent) {
-			matrix = parent->GetLocalTransform() * matrix;
-			parent = parent->Parent;
-		}
-
-		return matrix;
-	}
 	glm::mat4 GetAnimLocalTransform() const {
 		return glm::translate(glm::mat4(1.0f), AnimTranslation) * glm::mat4(AnimRotation) *
 		       glm::scale(glm::mat4(1.0f), AnimScale);
 	}
-	glm::mat4 GetAnimGlobalTransform() const {
-		glm::mat4 matrix = GetAnimLocalTransform();
-
-		Node* parent = Parent;
-		while (parent) {
-			matrix = parent->GetAnimLocalTransform() * matrix;
-			parent = parent->Parent;
-		}
 
-		return matrix;
+	void SetTranslation(const glm::vec3& translation) {
+		Translation = translation;
+		DirtyFlags |= NodeDirtyBits::Rest;
+	}
+	void SetRotation(const glm::quat& rotation) {
+		Rotation = rotation;
+		DirtyFlags |= NodeDirtyBits::Rest;
+	}
+	void SetScale(const glm::vec3& scale) {
+		Scale = scale;
+		DirtyFlags |= NodeDirtyBits::Rest;
+	}
+	void SetAnimTranslation(const glm::vec3& translation) {
+		AnimTranslation = translation;
+		DirtyFlags |= NodeDirtyBits::Anim;
+	}
+	void SetAnimRotation(const glm::quat& rotation) {
+		AnimRotation = rotation;
+		DirtyFlags |= NodeDirtyBits::Anim;
+	}
+	void SetAnimScale(const glm::vec3& scale) {
+		AnimScale = scale;
+		DirtyFlags |= NodeDirtyBits::Anim;
 	}
 	void ResetAnimation() {
 		AnimTranslation = Translation;
 		AnimRotation    = Rotation;
 		AnimScale       = Scale;
+		DirtyFlags |= NodeDirtyBits::Anim;
 	}
 };
 
@@ -298,8 +331,8 @@ struct Skin {
 
 struct AnimationSampler {
 	AnimationInterpolation Interpolation = AnimationInterpolation::Linear;
-	std::vector<float> Inputs;
-	std::vector<glm::vec4> Outputs;
+	uint32_t Times                       = 0;  // Which of the animation's TimeTracks holds the sampler's key times.
+	QuantizedKeys Keys;                        // One per key time, or three per key time for cubic splines.
 };
 
 struct AnimationChannel {
@@ -309,11 +342,18 @@ struct AnimationChannel {
 };
 
 struct Animation {
+	// Find the keyframes to blend for a channel's value at the given time, moving the cursor along. The keys are decoded
+	// into the four vectors at keys, which the blend points to. Linear rotations are slerped rather than lerped.
+	KeyframeBlend GetBlend(const AnimationChannel& channel, float time, KeyframeCursor& cursor, glm::vec4* keys) const;
+	// Whether the channel has a target and keys to sample. Morph target weights are not animated, so never are.
+	bool IsPlayable(const AnimationChannel& channel) const;
+
 	std::string Name;
 	float StartTime = 0.0f;
 	float EndTime   = 0.0f;
 	std::vector<AnimationChannel> Channels;
 	std::vector<AnimationSampler> Samplers;
+	std::vector<std::vector<float>> TimeTracks;  // Shared by every sampler with the same key times.
 };
 
 struct ProfileTimer {
@@ -334,11 +374,61 @@ struct ProfileTimer {
 	std::chrono::high_resolution_clock::time_point StartTime;
 };
 
+// How far a model has got through loading. Written by the thread loading the model and safe to read from any other, so
+// that progress can be shown while a model loads in the background.
+struct ModelLoadProgress {
+	static constexpr uint32_t StepCount = 8;
+
+	void BeginStep(uint32_t step, const char* name) {
+		StepName.store(name);
+		Step.store(step);
+	}
+	float GetFraction() const {
+		return float(Step.load()) / float(StepCount);
+	}
+
+	std::atomic<uint32_t> Step        = 0;
+	std::atomic<const char*> StepName = "Waiting";
+};
+
+// Options which change how a model is loaded rather than what it looks like once loaded.
+struct ModelLoadOptions {
+	// Create the model's images and buffers on the device. Without this, everything up to the upload is still done and
+	// profiled, but the model cannot be drawn. Used to benchmark importing without the cost of the driver.
+	bool UploadData = true;
+	// Print the load profile to the console once the model has loaded.
+	bool PrintProfile = true;
+};
+
 class Model {
  public:
-	Model(tk::Device& device, const std::filesystem::path& gltfPath);
+	// Every Vulkan object the model needs is created on the calling thread, and uploads are submitted through the
+	// device's transfer queue.
+	Model(tk::Device& device,
+	      const std::filesystem::path& gltfPath,
+	      ModelLoadProgress* progress     = nullptr,
+	      const ModelLoadOptions& options = {});
+	// Import the model without a device, as though UploadData were disabled. Every image format is assumed to be
+	// supported, and samplers are left empty, so the model can be profiled but never drawn.
+	explicit Model(const std::filesystem::path& gltfPath,
+	               ModelLoadProgress* progress     = nullptr,
+	               const ModelLoadOptions& options = {});
 
 	void ResetAnimation();
+	// Recompute the world transforms of every node whose local transform, or whose ancestor's, has changed since the
+	// last update. Call once per frame, after animating and before reading any world transforms.
+	void UpdateTransforms();
+
+	const glm::mat4& GetWorldTransform(const Node* node) const {
+		return _worldTransforms[node->TransformIndex];
+	}
+	const glm::mat4& GetAnimWorldTransform(const Node* node) const {
+		return _animWorldTransforms[node->TransformIndex];
+	}
+	// The world transform the node is drawn with: animated if the model is animating, and at rest otherwise.
+	const glm::mat4& GetDrawTransform(const Node* node) const {
+		return Animate ? GetAnimWorldTransform(node) : GetWorldTransform(node);
+	}
 
 	std::string Name;
 	glm::mat4 AABB;
@@ -355,31 +445,110 @@ class Model {
 	bool Animate             = true;
 	uint32_t ActiveAnimation = 0;
 
+	// How long each stage of loading the model took. Filled in once the model has finished loading.
+	ModelLoadProfile LoadProfile;
+
  private:
+	Model(tk::Device* device,
+	      const std::filesystem::path& gltfPath,
+	      ModelLoadProgress* progress,
+	      const ModelLoadOptions& options);
+
+	void BuildLoadProfile(const std::filesystem::path& gltfPath, double timeLoad);
 	void CalculateBounds(Node* node, Node* parent);
 	void ImportAnimations(const fastgltf::Asset& gltfModel);
-	void ImportImages(const fastgltf::Asset& gltfModel, const std::filesystem::path& gltfPath, tk::Device& device);
+	void ImportImages(const fastgltf::Asset& gltfModel, const std::filesystem::path& gltfPath, tk::Device* device);
 	void ImportMaterials(const fastgltf::Asset& gltfModel);
-	void ImportMeshes(const fastgltf::Asset& gltfModel, tk::Device& device);
+	void ImportMeshes(const fastgltf::Asset& gltfModel, tk::Device* device);
 	void ImportNodes(const fastgltf::Asset& gltfModel);
-	void ImportSamplers(const fastgltf::Asset& gltfModel, tk::Device& device);
-	void ImportSkins(const fastgltf::Asset& gltfModel, tk::Device& device);
+	void ImportSamplers(const fastgltf::Asset& gltfModel, tk::Device* device);
+	void ImportSkins(const fastgltf::Asset& gltfModel, tk::Device* device);
 	void ImportTextures(const fastgltf::Asset& gltfModel);
 
 	void ImportMesh(const fastgltf::Asset& gltfModel, const fastgltf::Mesh& gltfMesh, Mesh& mesh);
+	GeometryCache BakeMeshes(const fastgltf::Asset& gltfModel);
 
+	ModelLoadOptions _options;
 	Material* _defaultMaterial = nullptr;
 	Sampler* _defaultSampler   = nullptr;
 	std::vector<std::shared_ptr<Node>> _nodes;
+
+	// Every node's transforms, in an order where each node comes after its parent, so that world transforms can be
+	// computed in a single pass. Parents are indices into the same order, or -1 for nodes without one.
+	std::vector<Node*> _transformNodes;
+	std::vector<int32_t> _transformParents;
+	std::vector<NodeDirtyFlags> _transformChanged;
+	std::vector<glm::mat4> _localTransforms;
+	std::vector<glm::mat4> _worldTransforms;
+	std::vector<glm::mat4> _animLocalTransforms;
+	std::vector<glm::mat4> _animWorldTransforms;
 	glm::vec3 _minDim = glm::vec3(std::numeric_limits<float>::max());
 	glm::vec3 _maxDim = glm::vec3(std::numeric_limits<float>::lowest());
 
+	// Only valid while the model is loading.
+	std::vector<MappedFile> _bufferFiles;
+	std::vector<std::span<const uint8_t>> _buffers;
+	// The glTF image each texture is drawn with, after choosing between a KTX2 source and its fallback.
+	std::vector<size_t> _textureImages;
+
+	tk::Hash _geometryKey  = 0;
+	bool _geometryCacheHit = false;
+
 	double _timeParse               = 0.0;
 	double _timeBufferLoad          = 0.0;
+	double _timeImageLoad           = 0.0;
+	double _timeImageHash           = 0.0;
+	double _timeImageDecode         = 0.0;
+	double _timeImageCompress       = 0.0;
+	double _timeImageUpload         = 0.0;
+	double _timeMaterialLoad        = 0.0;
 	double _timeMeshLoad            = 0.0;
 	double _timeVertexLoad          = 0.0;
 	double _timeUnpackVertices      = 0.0;
 	double _timeGenerateFlatNormals = 0.0;
 	double _timeGenerateTangents    = 0.0;
 	double _timeWeldVertices        = 0.0;
+	double _timeGeometryHash        = 0.0;
+	double _timeGeometryCache       = 0.0;
+	double _timeOptimizeVertexCache = 0.0;
+	double _timeOptimizeOverdraw    = 0.0;
+	double _timeBuildMeshlets       = 0.0;
+	double _timeGenerateLods        = 0.0;
+	double _timeOptimizeVertexFetch = 0.0;
+	double _timePackVertices        = 0.0;
+	double _timeMeshUpload          = 0.0;
+	double _timeNodeLoad            = 0.0;
+	double _timeSkinLoad            = 0.0;
+	double _timeAnimationLoad       = 0.0;
+	std::vector<LoadProfileStage> _imageDecodeStages;
+	std::vector<double> _meshProcessTimes;
+	std::vector<LoadProfileStage> _meshStages;
+	VertexCacheStats _vertexCacheBefore;
+	VertexCacheStats _vertexCacheAfter;
+	OverdrawStats _overdrawBefore;
+	OverdrawStats _overdrawAfter;
+	VertexFetchStats _vertexFetchBefore;
+	VertexFetchStats _vertexFetchAfter;
+	MeshletStats _meshletStats;
+	size_t _lodCount                          = 0;
+	size_t _lodIndexCount                     = 0;
+	size_t _texturesCompressed                = 0;
+	size_t _texturesFromCache                 = 0;
+	size_t _imagesShared                      = 0;
+	uint64_t _gltfDataSize                    = 0;
+	uint64_t _bufferDataSize                  = 0;
+	uint64_t _geometryHashDataSize            = 0;
+	uint64_t _imageSourceDataSize             = 0;
+	vk::DeviceSize _imageUploadDataSize       = 0;
+	vk::DeviceSize _compressedImageDataSize   = 0;
+	vk::DeviceSize _uncompressedImageDataSize = 0;
+	vk::DeviceSize _vertexDataSize            = 0;
+	vk::DeviceSize _unpackedVertexDataSize    = 0;
+	vk::DeviceSize _indexDataSize             = 0;
+	vk::DeviceSize _unpackedIndexDataSize     = 0;
+	vk::DeviceSize _meshDataSize              = 0;
+	size_t _animationKeys                     = 0;
+	size_t _animationKeysKept                 = 0;
+	uint64_t _unpackedAnimationDataSize       = 0;
+	uint64_t _animationDataSize               = 0;
 };
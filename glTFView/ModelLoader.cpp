@@ -0,0 +1,80 @@
+#include "ModelLoader.hpp"
+
+#include <Tsuki/CommandBuffer.hpp>
+#include <Tsuki/Device.hpp>
+#include <Tsuki/Fence.hpp>
+#include <iostream>
+
+ModelLoader::ModelLoader(tk::Device& device) : _device(device), _thread(&ModelLoader::LoaderMain, this) {}
+
+ModelLoader::~ModelLoader() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_shutdown = true;
+	}
+	_requestAvailable.notify_all();
+	_thread.join();
+}
+
+void ModelLoader::Load(const std::filesystem::path& gltfPath) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_pendingPath = gltfPath;
+	}
+	_requestAvailable.notify_all();
+}
+
+std::unique_ptr<Model> ModelLoader::TakeModel() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return std::move(_loadedModel);
+}
+
+bool ModelLoader::IsLoading() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _pendingPath.has_value() || !_loadingPath.empty();
+}
+
+std::filesystem::path ModelLoader::GetLoadingPath() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _loadingPath.empty() && _pendingPath ? *_pendingPath : _loadingPath;
+}
+
+void ModelLoader::LoaderMain() {
+	// The render thread keeps recording while we load, so we need command pools of our own.
+	tk::Device::SetThreadIndex(ThreadIndex);
+
+	while (true) {
+		std::filesystem::path gltfPath;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_requestAvailable.wait(lock, [this]() { return _shutdown || _pendingPath.has_value(); });
+			if (_shutdown) { return; }
+
+			gltfPath     = *_pendingPath;
+			_loadingPath = gltfPath;
+			_pendingPath.reset();
+		}
+		_progress.BeginStep(0, "Waiting");
+
+		std::unique_ptr<Model> model;
+		try {
+			std::cout << "Loading glTF model " << gltfPath.string() << std::endl;
+			model = std::make_unique<Model>(_device, gltfPath, &_progress);
+
+			// Every buffer and image upload goes through the transfer queue, so once a fence submitted behind them has
+			// signalled, they have all completed. Anything the uploads left for the graphics queue (such as mipmap
+			// generation) is already queued ahead of any frame that could draw the model.
+			_progress.BeginStep(ModelLoadProgress::StepCount - 1, "Waiting for Uploads");
+			tk::FenceHandle uploadFence;
+			_device.Submit(_device.RequestCommandBuffer(tk::CommandBufferType::AsyncTransfer), &uploadFence);
+			uploadFence->Wait();
+		} catch (const std::exception& e) {
+			std::cerr << "Failed to load model from '" << gltfPath.string() << "': " << e.what() << std::endl;
+			model.reset();
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (model) { _loadedModel = std::move(model); }
+		_loadingPath.clear();
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Tsuki/Common.hpp>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "Model.hpp"
+
+// Loads models on a background thread, so that the window keeps rendering (and can keep showing the previous model)
+// while a new one is parsed, decoded, processed and uploaded. A model is only handed over once every upload it made
+// has completed on the GPU.
+class ModelLoader {
+ public:
+	// The device thread index the loader records its command buffers with.
+	static constexpr uint32_t ThreadIndex = 1;
+
+	explicit ModelLoader(tk::Device& device);
+	ModelLoader(const ModelLoader&)            = delete;
+	ModelLoader& operator=(const ModelLoader&) = delete;
+	// Waits for the model currently loading, if any, to finish.
+	~ModelLoader() noexcept;
+
+	// Queue a model to be loaded. A request which has not started loading yet is replaced, so that dropping several
+	// models in quick succession only loads the last of them.
+	void Load(const std::filesystem::path& gltfPath);
+	// Take the most recently finished model, or nullptr if none has finished since the last call.
+	std::unique_ptr<Model> TakeModel();
+
+	bool IsLoading() const;
+	// The path of the model being loaded, or empty if none is.
+	std::filesystem::path GetLoadingPath() const;
+	const ModelLoadProgress& GetProgress() const {
+		return _progress;
+	}
+
+ private:
+	void LoaderMain();
+
+	tk::Device& _device;
+	ModelLoadProgress _progress;
+
+	mutable std::mutex _mutex;
+	std::condition_variable _requestAvailable;
+	std::optional<std::filesystem::path> _pendingPath;
+	std::filesystem::path _loadingPath;
+	std::unique_ptr<Model> _loadedModel;
+	bool _shutdown = false;
+
+	// Declared last, so that everything the thread uses exists before it starts.
+	std::thread _thread;
+};
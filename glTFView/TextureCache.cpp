@@ -0,0 +1,110 @@
+#include "TextureCache.hpp"
+
+#include <Tsuki/TextureFormat.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "TextureCompression.hpp"
+
+static constexpr size_t DataAlignment = 16;
+
+static size_t AlignUp(size_t value, size_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+TextureCache::TextureCache(vk::Format format, uint32_t width, uint32_t height)
+		: _format(format), _width(width), _height(height) {}
+
+std::filesystem::path TextureCache::GetCachePath(tk::Hash key) {
+	std::stringstream name;
+	name << std::hex << key << ".tex";
+
+	return std::filesystem::path("Cache") / "Textures" / name.str();
+}
+
+void TextureCache::AddLevel(std::vector<uint8_t> data) {
+	const LevelRecord level{.DataOffset = AlignUp(_levelData.size(), DataAlignment), .DataSize = data.size()};
+	_levelRecords.push_back(level);
+	_levelData.resize(level.DataOffset + level.DataSize);
+	memcpy(_levelData.data() + level.DataOffset, data.data(), data.size());
+
+	_levels = _levelRecords;
+	_data   = _levelData;
+}
+
+bool TextureCache::Load(const std::filesystem::path& cachePath, tk::Hash key) {
+	if (!std::filesystem::exists(cachePath)) { return false; }
+
+	try {
+		_file = MappedFile(cachePath);
+	} catch (const std::exception& e) { return false; }
+
+	// Validate everything we can before trusting any of the offsets in the file.
+	Header header;
+	if (_file.Size() < sizeof(header)) { return false; }
+	memcpy(&header, _file.Data(), sizeof(header));
+	if (header.Magic != FileMagic || header.Version != FileVersion || header.Key != key) { return false; }
+
+	// The levels must form a mip chain of the image the header describes, so that a cache written for a different size
+	// or format is never uploaded as this one.
+	const vk::Format format = static_cast<vk::Format>(header.Format);
+	if (!CanCompressImage(format) || header.Width == 0 || header.Height == 0) { return false; }
+	if (header.LevelCount > tk::TextureFormatLayout::MipLevels(header.Width, header.Height)) { return false; }
+
+	// The level count is already bounded by the mip count, so the table size cannot overflow. Everything else is read
+	// from the file and checked by subtraction, so that a corrupt cache cannot wrap around.
+	const size_t levelOffset = sizeof(Header);
+	const size_t tablesEnd   = levelOffset + header.LevelCount * sizeof(LevelRecord);
+	if (tablesEnd > header.DataOffset || header.DataOffset % DataAlignment != 0 ||
+	    !RangeFits(header.DataOffset, header.DataSize, _file.Size())) {
+		return false;
+	}
+
+	const std::span<const LevelRecord> levels = {reinterpret_cast<const LevelRecord*>(_file.Data() + levelOffset),
+	                                             header.LevelCount};
+	for (uint32_t i = 0; i < header.LevelCount; ++i) {
+		const auto& level      = levels[i];
+		const size_t levelSize =
+			GetCompressedImageSize(format, std::max(header.Width >> i, 1u), std::max(header.Height >> i, 1u));
+		if (level.DataSize != levelSize || !RangeFits(level.DataOffset, level.DataSize, header.DataSize)) { return false; }
+	}
+
+	_format = format;
+	_width  = header.Width;
+	_height = header.Height;
+	_levels = levels;
+	_data   = {_file.Data() + header.DataOffset, header.DataSize};
+
+	return true;
+}
+
+void TextureCache::Save(const std::filesystem::path& cachePath, tk::Hash key) const {
+	Header header{.Key        = key,
+	              .Format     = static_cast<uint32_t>(_format),
+	              .Width      = _width,
+	              .Height     = _height,
+	              .LevelCount = static_cast<uint32_t>(_levels.size()),
+	              .DataSize   = _data.size()};
+	const size_t tablesEnd = sizeof(Header) + _levels.size_bytes();
+	header.DataOffset      = AlignUp(tablesEnd, DataAlignment);
+
+	std::filesystem::create_directories(cachePath.parent_path());
+
+	// Write to a temporary file first, so that an interrupted write never leaves a truncated cache behind.
+	auto tempPath = cachePath;
+	tempPath += ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) { throw std::runtime_error("Failed to open file for writing!"); }
+
+		const char padding[DataAlignment] = {};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(_levels.data()), _levels.size_bytes());
+		file.write(padding, header.DataOffset - tablesEnd);
+		file.write(reinterpret_cast<const char*>(_data.data()), _data.size());
+		if (!file.good()) { throw std::runtime_error("Failed to write texture cache!"); }
+	}
+	std::filesystem::rename(tempPath, cachePath);
+}
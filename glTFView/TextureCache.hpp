@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Tsuki/Common.hpp>
+#include <Tsuki/Hash.hpp>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "Files.hpp"
+
+// An on-disk cache of textures which have been block compressed on import, so that the cost of compressing an image is
+// only paid the first time it is seen. A cache file holds a header, a table of mip level records, and then the data of
+// every level, ready to be uploaded as-is.
+class TextureCache {
+ public:
+	static constexpr uint32_t FileMagic   = 0x58455454;  // "TTEX"
+	static constexpr uint32_t FileVersion = 1;
+
+	struct Header {
+		uint32_t Magic      = FileMagic;
+		uint32_t Version    = FileVersion;
+		tk::Hash Key        = 0;
+		uint32_t Format     = 0;  // A vk::Format.
+		uint32_t Width      = 0;
+		uint32_t Height     = 0;
+		uint32_t LevelCount = 0;
+		uint64_t DataOffset = 0;
+		uint64_t DataSize   = 0;
+	};
+
+	struct LevelRecord {
+		uint64_t DataOffset = 0;
+		uint64_t DataSize   = 0;
+	};
+
+	TextureCache() = default;
+	// Begin building a cache in memory for an image of the given format and size.
+	TextureCache(vk::Format format, uint32_t width, uint32_t height);
+	TextureCache(const TextureCache&)            = delete;
+	TextureCache(TextureCache&&)                 = default;
+	TextureCache& operator=(const TextureCache&) = delete;
+	TextureCache& operator=(TextureCache&&)      = default;
+
+	static std::filesystem::path GetCachePath(tk::Hash key);
+
+	// Append the next mip level to a cache being built in memory.
+	void AddLevel(std::vector<uint8_t> data);
+	// Load a cache file, returning false if it does not exist, does not match the given key, or its levels are not the
+	// mip chain of its format and size. The file stays mapped for the lifetime of the cache, so levels can be uploaded
+	// straight from the page cache.
+	bool Load(const std::filesystem::path& cachePath, tk::Hash key);
+	void Save(const std::filesystem::path& cachePath, tk::Hash key) const;
+
+	vk::Format GetFormat() const {
+		return _format;
+	}
+	uint32_t GetWidth() const {
+		return _width;
+	}
+	uint32_t GetHeight() const {
+		return _height;
+	}
+	size_t GetLevelCount() const {
+		return _levels.size();
+	}
+	std::span<const uint8_t> GetLevel(size_t level) const {
+		return _data.subspan(_levels[level].DataOffset, _levels[level].DataSize);
+	}
+	size_t GetDataSize() const {
+		return _data.size();
+	}
+
+ private:
+	vk::Format _format = vk::Format::eUndefined;
+	uint32_t _width    = 0;
+	uint32_t _height   = 0;
+
+	std::vector<LevelRecord> _levelRecords;
+	std::vector<uint8_t> _levelData;
+	MappedFile _file;
+
+	std::span<const LevelRecord> _levels;
+	std::span<const uint8_t> _data;
+};
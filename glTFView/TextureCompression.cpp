@@ -0,0 +1,418 @@
+#include "TextureCompression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "ThreadPool.hpp"
+
+namespace {
+// A 4x4 block of RGBA texels, in row order.
+using BlockTexels = std::array<std::array<float, 4>, 16>;
+
+// The interpolation weights for BC7's 4-bit indices, out of 64.
+constexpr int BC7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+class BitWriter {
+ public:
+	explicit BitWriter(uint8_t* data) : _data(data) {}
+
+	void Write(uint32_t value, uint32_t bitCount) {
+		for (uint32_t i = 0; i < bitCount; ++i, ++_offset) {
+			if ((value >> i) & 1) { _data[_offset / 8] |= 1 << (_offset % 8); }
+		}
+	}
+
+ private:
+	uint8_t* _data;
+	uint32_t _offset = 0;
+};
+
+size_t GetBlockSize(vk::Format format) {
+	switch (format) {
+		case vk::Format::eBc1RgbUnormBlock:
+		case vk::Format::eBc1RgbSrgbBlock:
+		case vk::Format::eBc4UnormBlock:
+			return 8;
+
+		case vk::Format::eBc5UnormBlock:
+		case vk::Format::eBc7UnormBlock:
+		case vk::Format::eBc7SrgbBlock:
+			return 16;
+
+		default:
+			return 0;
+	}
+}
+
+// Fit a line through the first channelCount channels of a block's texels, along their principal axis, and return the
+// points where the texels' projections onto the line begin and end.
+void FitEndpoints(const BlockTexels& texels, int channelCount, float* endpoint0, float* endpoint1) {
+	float mean[4]     = {};
+	float minValue[4] = {255.0f, 255.0f, 255.0f, 255.0f};
+	float maxValue[4] = {};
+	for (const auto& texel : texels) {
+		for (int c = 0; c < channelCount; ++c) {
+			mean[c] += texel[c] / 16.0f;
+			minValue[c] = std::min(minValue[c], texel[c]);
+			maxValue[c] = std::max(maxValue[c], texel[c]);
+		}
+	}
+
+	float covariance[4][4] = {};
+	for (const auto& texel : texels) {
+		for (int i = 0; i < channelCount; ++i) {
+			for (int j = 0; j < channelCount; ++j) { covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]); }
+		}
+	}
+
+	// Find the principal axis by power iteration, starting from the diagonal of the block's bounds.
+	float axis[4] = {};
+	for (int c = 0; c < channelCount; ++c) { axis[c] = maxValue[c] - minValue[c]; }
+	for (int iteration = 0; iteration < 8; ++iteration) {
+		float next[4] = {};
+		for (int i = 0; i < channelCount; ++i) {
+			for (int j = 0; j < channelCount; ++j) { next[i] += covariance[i][j] * axis[j]; }
+		}
+		float largest = 0.0f;
+		for (int c = 0; c < channelCount; ++c) { largest = std::max(largest, std::abs(next[c])); }
+		if (largest == 0.0f) { break; }
+		for (int c = 0; c < channelCount; ++c) { axis[c] = next[c] / largest; }
+	}
+
+	float axisLength = 0.0f;
+	for (int c = 0; c < channelCount; ++c) { axisLength += axis[c] * axis[c]; }
+	if (axisLength == 0.0f) {
+		// Every texel is the same.
+		for (int c = 0; c < channelCount; ++c) { endpoint0[c] = endpoint1[c] = mean[c]; }
+		return;
+	}
+	axisLength = std::sqrt(axisLength);
+	for (int c = 0; c < channelCount; ++c) { axis[c] /= axisLength; }
+
+	float tMin = FLT_MAX;
+	float tMax = -FLT_MAX;
+	for (const auto& texel : texels) {
+		float t = 0.0f;
+		for (int c = 0; c < channelCount; ++c) { t += (texel[c] - mean[c]) * axis[c]; }
+		tMin = std::min(tMin, t);
+		tMax = std::max(tMax, t);
+	}
+	for (int c = 0; c < channelCount; ++c) {
+		endpoint0[c] = std::clamp(mean[c] + axis[c] * tMin, 0.0f, 255.0f);
+		endpoint1[c] = std::clamp(mean[c] + axis[c] * tMax, 0.0f, 255.0f);
+	}
+}
+
+uint16_t PackRgb565(const float* color) {
+	const uint32_t r = std::lround(color[0] * 31.0f / 255.0f);
+	const uint32_t g = std::lround(color[1] * 63.0f / 255.0f);
+	const uint32_t b = std::lround(color[2] * 31.0f / 255.0f);
+
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void UnpackRgb565(uint16_t color, int* rgb) {
+	const int r = (color >> 11) & 0x1f;
+	const int g = (color >> 5) & 0x3f;
+	const int b = color & 0x1f;
+	rgb[0]      = (r << 3) | (r >> 2);
+	rgb[1]      = (g << 2) | (g >> 4);
+	rgb[2]      = (b << 3) | (b >> 2);
+}
+
+void EncodeBC1Block(const BlockTexels& texels, uint8_t* block) {
+	float endpoint0[4], endpoint1[4];
+	FitEndpoints(texels, 3, endpoint0, endpoint1);
+
+	// Four colour mode (rather than three colours and transparency) is used when the first endpoint is the larger.
+	uint16_t color0 = PackRgb565(endpoint1);
+	uint16_t color1 = PackRgb565(endpoint0);
+	if (color0 < color1) { std::swap(color0, color1); }
+
+	uint32_t indices = 0;
+	if (color0 != color1) {
+		int palette[4][3];
+		UnpackRgb565(color0, palette[0]);
+		UnpackRgb565(color1, palette[1]);
+		for (int c = 0; c < 3; ++c) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; ++i) {
+			uint32_t bestIndex = 0;
+			float bestError    = FLT_MAX;
+			for (uint32_t index = 0; index < 4; ++index) {
+				float error = 0.0f;
+				for (int c = 0; c < 3; ++c) {
+					const float delta = texels[i][c] - palette[index][c];
+					error += delta * delta;
+				}
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+			indices |= bestIndex << (i * 2);
+		}
+	}
+
+	block[0] = color0 & 0xff;
+	block[1] = color0 >> 8;
+	block[2] = color1 & 0xff;
+	block[3] = color1 >> 8;
+	for (int i = 0; i < 4; ++i) { block[4 + i] = (indices >> (i * 8)) & 0xff; }
+}
+
+void EncodeBC4Block(const BlockTexels& texels, int channel, uint8_t* block) {
+	float minValue = 255.0f;
+	float maxValue = 0.0f;
+	for (const auto& texel : texels) {
+		minValue = std::min(minValue, texel[channel]);
+		maxValue = std::max(maxValue, texel[channel]);
+	}
+
+	// With the first endpoint the larger, the palette holds both endpoints and six values evenly spaced between them.
+	const int value0 = std::lround(maxValue);
+	const int value1 = std::lround(minValue);
+	block[0]         = static_cast<uint8_t>(value0);
+	block[1]         = static_cast<uint8_t>(value1);
+
+	uint64_t indices = 0;
+	if (value0 > value1) {
+		float palette[8] = {float(value0), float(value1)};
+		for (int i = 2; i < 8; ++i) { palette[i] = ((8 - i) * value0 + (i - 1) * value1) / 7.0f; }
+
+		for (int i = 0; i < 16; ++i) {
+			uint64_t bestIndex = 0;
+			float bestError    = FLT_MAX;
+			for (uint64_t index = 0; index < 8; ++index) {
+				const float error = std::abs(texels[i][channel] - palette[index]);
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+			indices |= bestIndex << (i * 3);
+		}
+	}
+
+	for (int i = 0; i < 6; ++i) { block[2 + i] = (indices >> (i * 8)) & 0xff; }
+}
+
+// Encode a block with BC7 mode 6: a single pair of RGBA endpoints with 7 bits per channel and a low bit (p-bit) per
+// endpoint shared by all channels, and a 4-bit index per texel.
+void EncodeBC7Block(const BlockTexels& texels, uint8_t* block) {
+	float endpoints[2][4];
+	FitEndpoints(texels, 4, endpoints[0], endpoints[1]);
+
+	// Try every combination of p-bits and keep whichever fits the block best.
+	float bestError = FLT_MAX;
+	int bestQuantized[2][4];
+	int bestPBits[2];
+	int bestIndices[16];
+	for (int pBits = 0; pBits < 4; ++pBits) {
+		const int p[2] = {pBits & 1, pBits >> 1};
+		int quantized[2][4];
+		int values[2][4];
+		for (int e = 0; e < 2; ++e) {
+			for (int c = 0; c < 4; ++c) {
+				quantized[e][c] = std::clamp<int>(std::lround((endpoints[e][c] - p[e]) / 2.0f), 0, 127);
+				values[e][c]    = (quantized[e][c] << 1) | p[e];
+			}
+		}
+
+		int palette[16][4];
+		for (int i = 0; i < 16; ++i) {
+			for (int c = 0; c < 4; ++c) {
+				palette[i][c] = ((64 - BC7Weights[i]) * values[0][c] + BC7Weights[i] * values[1][c] + 32) >> 6;
+			}
+		}
+
+		float direction[4];
+		float directionLength = 0.0f;
+		for (int c = 0; c < 4; ++c) {
+			direction[c] = float(values[1][c] - values[0][c]);
+			directionLength += direction[c] * direction[c];
+		}
+
+		// Find each texel's index by projecting it onto the line between the endpoints, then checking the neighbouring
+		// indices, as the weights are not quite evenly spaced.
+		float error = 0.0f;
+		int indices[16];
+		for (int i = 0; i < 16; ++i) {
+			int guess = 0;
+			if (directionLength > 0.0f) {
+				float t = 0.0f;
+				for (int c = 0; c < 4; ++c) { t += (texels[i][c] - values[0][c]) * direction[c]; }
+				guess = std::clamp<int>(std::lround(t / directionLength * 15.0f), 0, 15);
+			}
+
+			float bestTexelError = FLT_MAX;
+			for (int index = std::max(guess - 1, 0); index <= std::min(guess + 1, 15); ++index) {
+				float texelError = 0.0f;
+				for (int c = 0; c < 4; ++c) {
+					const float delta = texels[i][c] - palette[index][c];
+					texelError += delta * delta;
+				}
+				if (texelError < bestTexelError) {
+					bestTexelError = texelError;
+					indices[i]     = index;
+				}
+			}
+			error += bestTexelError;
+		}
+
+		if (error < bestError) {
+			bestError = error;
+			std::memcpy(bestQuantized, quantized, sizeof(quantized));
+			std::memcpy(bestPBits, p, sizeof(p));
+			std::memcpy(bestIndices, indices, sizeof(indices));
+		}
+	}
+
+	// The top bit of the first texel's index is implied to be zero, so swap the endpoints if it would be set.
+	if (bestIndices[0] >= 8) {
+		std::swap(bestQuantized[0], bestQuantized[1]);
+		std::swap(bestPBits[0], bestPBits[1]);
+		for (auto& index : bestIndices) { index = 15 - index; }
+	}
+
+	std::memset(block, 0, 16);
+	BitWriter writer(block);
+	writer.Write(1 << 6, 7);
+	for (int c = 0; c < 4; ++c) {
+		writer.Write(bestQuantized[0][c], 7);
+		writer.Write(bestQuantized[1][c], 7);
+	}
+	writer.Write(bestPBits[0], 1);
+	writer.Write(bestPBits[1], 1);
+	writer.Write(bestIndices[0], 3);
+	for (int i = 1; i < 16; ++i) { writer.Write(bestIndices[i], 4); }
+}
+
+float LinearToSrgb(float value) {
+	return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+// The source texels one texel of the next mip level covers along a single axis. From an even size, each covers exactly
+// two. From an odd size, each covers 2 + 1/n of them, so three are weighted such that every source texel, including
+// those in the last row and column, contributes equally to the level below.
+struct DownsampleTaps {
+	uint32_t Count = 0;
+	uint32_t Index[3];
+	float Weight[3];
+};
+
+std::vector<DownsampleTaps> GetDownsampleTaps(uint32_t size) {
+	const uint32_t half = std::max(size / 2, 1u);
+	std::vector<DownsampleTaps> taps(half);
+	for (uint32_t i = 0; i < half; ++i) {
+		if (size == 1) {
+			taps[i] = {.Count = 1, .Index = {0}, .Weight = {1.0f}};
+		} else if (size % 2 == 0) {
+			taps[i] = {.Count = 2, .Index = {i * 2, i * 2 + 1}, .Weight = {0.5f, 0.5f}};
+		} else {
+			const float span = float(size);
+			taps[i]          = {.Count  = 3,
+			                    .Index  = {i * 2, i * 2 + 1, i * 2 + 2},
+			                    .Weight = {(half - i) / span, half / span, (i + 1) / span}};
+		}
+	}
+
+	return taps;
+}
+}  // namespace
+
+bool CanCompressImage(vk::Format format) {
+	return GetBlockSize(format) != 0;
+}
+
+size_t GetCompressedImageSize(vk::Format format, uint32_t width, uint32_t height) {
+	return size_t((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+std::vector<uint8_t> CompressImage(vk::Format format, const uint8_t* pixels, uint32_t width, uint32_t height) {
+	const uint32_t blocksX = (width + 3) / 4;
+	const uint32_t blocksY = (height + 3) / 4;
+	const size_t blockSize = GetBlockSize(format);
+	std::vector<uint8_t> compressed(GetCompressedImageSize(format, width, height));
+
+	ThreadPool::Get().ParallelFor(blocksY, [&](size_t blockY) {
+		BlockTexels texels;
+		for (uint32_t blockX = 0; blockX < blocksX; ++blockX) {
+			for (uint32_t y = 0; y < 4; ++y) {
+				const uint32_t sourceY = std::min<uint32_t>(blockY * 4 + y, height - 1);
+				for (uint32_t x = 0; x < 4; ++x) {
+					const uint32_t sourceX = std::min<uint32_t>(blockX * 4 + x, width - 1);
+					const uint8_t* texel   = pixels + (size_t(sourceY) * width + sourceX) * 4;
+					for (int c = 0; c < 4; ++c) { texels[y * 4 + x][c] = texel[c]; }
+				}
+			}
+
+			uint8_t* block = compressed.data() + (blockY * blocksX + blockX) * blockSize;
+			switch (format) {
+				case vk::Format::eBc1RgbUnormBlock:
+				case vk::Format::eBc1RgbSrgbBlock:
+					EncodeBC1Block(texels, block);
+					break;
+				case vk::Format::eBc4UnormBlock:
+					EncodeBC4Block(texels, 0, block);
+					break;
+				case vk::Format::eBc5UnormBlock:
+					EncodeBC4Block(texels, 0, block);
+					EncodeBC4Block(texels, 1, block + 8);
+					break;
+				default:
+					EncodeBC7Block(texels, block);
+					break;
+			}
+		}
+	});
+
+	return compressed;
+}
+
+std::vector<uint8_t> DownsampleImage(const uint8_t* pixels, uint32_t width, uint32_t height, bool srgb) {
+	static const auto SrgbToLinear = []() {
+		std::array<float, 256> table;
+		for (int i = 0; i < 256; ++i) {
+			const float value = i / 255.0f;
+			table[i]          = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+		return table;
+	}();
+
+	const auto columnTaps     = GetDownsampleTaps(width);
+	const auto rowTaps        = GetDownsampleTaps(height);
+	const uint32_t halfWidth  = static_cast<uint32_t>(columnTaps.size());
+	const uint32_t halfHeight = static_cast<uint32_t>(rowTaps.size());
+	std::vector<uint8_t> downsampled(size_t(halfWidth) * halfHeight * 4);
+
+	ThreadPool::Get().ParallelFor(halfHeight, [&](size_t y) {
+		const auto& rows = rowTaps[y];
+		for (uint32_t x = 0; x < halfWidth; ++x) {
+			const auto& columns = columnTaps[x];
+			float sum[4]        = {};
+			for (uint32_t j = 0; j < rows.Count; ++j) {
+				const uint8_t* row = pixels + size_t(rows.Index[j]) * width * 4;
+				for (uint32_t i = 0; i < columns.Count; ++i) {
+					const uint8_t* texel = row + size_t(columns.Index[i]) * 4;
+					const float weight   = rows.Weight[j] * columns.Weight[i];
+					for (int c = 0; c < 4; ++c) { sum[c] += weight * (srgb && c < 3 ? SrgbToLinear[texel[c]] : texel[c]); }
+				}
+			}
+
+			uint8_t* destination = downsampled.data() + (y * halfWidth + x) * 4;
+			for (int c = 0; c < 4; ++c) {
+				const float value = srgb && c < 3 ? LinearToSrgb(sum[c]) * 255.0f : sum[c];
+				destination[c]    = static_cast<uint8_t>(std::clamp<long>(std::lround(value), 0, 255));
+			}
+		}
+	});
+
+	return downsampled;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Tsuki/Common.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU encoders for the BCn block compressed formats, so that textures which only ship as PNG or JPEG can still be
+// stored compressed on the GPU. The encoders fit a single line through each block rather than searching exhaustively:
+//   - BC1 (RGB, 4 bits per texel), for packed occlusion/roughness/metallic maps.
+//   - BC4 (R, 4 bits per texel), for occlusion maps. Encodes the red channel.
+//   - BC5 (RG, 8 bits per texel), for normal maps. Encodes the red and green channels.
+//   - BC7 (RGBA, 8 bits per texel), for everything else. Only mode 6 is used, with one pair of endpoints per block.
+
+// Whether the given format is one of the block compressed formats CompressImage can encode.
+bool CanCompressImage(vk::Format format);
+
+// The size in bytes of an image of the given size once compressed.
+size_t GetCompressedImageSize(vk::Format format, uint32_t width, uint32_t height);
+
+// Compress tightly packed RGBA8 pixels into the given format. Images whose size is not a multiple of the block size
+// have their edge texels repeated to fill the last row and column of blocks. Rows of blocks are compressed in parallel
+// on the thread pool.
+std::vector<uint8_t> CompressImage(vk::Format format, const uint8_t* pixels, uint32_t width, uint32_t height);
+
+// Halve the size of tightly packed RGBA8 pixels with a box filter, producing the next level of a mip chain. Odd sizes
+// round down, with each texel covering slightly more than two of the source, so that the last row and column still
+// contribute. Srgb images are filtered in linear space, so that they do not darken with each level.
+std::vector<uint8_t> DownsampleImage(const uint8_t* pixels, uint32_t width, uint32_t height, bool srgb);
@@ -0,0 +1,84 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t threadCount) {
+	// The thread calling ParallelFor always helps out, so one less worker is needed to saturate every core.
+	threadCount = std::max(threadCount, 2u) - 1;
+
+	_threads.reserve(threadCount);
+	for (uint32_t i = 0; i < threadCount; ++i) { _threads.emplace_back(&ThreadPool::WorkerMain, this); }
+}
+
+ThreadPool::~ThreadPool() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_shutdown = true;
+	}
+	_workAvailable.notify_all();
+	for (auto& thread : _threads) { thread.join(); }
+}
+
+ThreadPool& ThreadPool::Get() {
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& func) {
+	if (count == 0) { return; }
+	if (count == 1 || _threads.empty()) {
+		for (size_t i = 0; i < count; ++i) { func(i); }
+		return;
+	}
+
+	// Hand out work in small batches, so that cheap items don't spend all of their time fighting over the lock, while
+	// still leaving enough batches for the threads to balance out uneven items.
+	Job job{.Func = &func, .Count = count, .Remaining = count};
+	job.Batch = std::max<size_t>(1, count / ((_threads.size() + 1) * 4));
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_jobs.push_back(&job);
+	_workAvailable.notify_all();
+
+	while (RunBatch(job, lock)) {}
+	_workComplete.wait(lock, [&job]() { return job.Remaining == 0; });
+	lock.unlock();
+
+	if (job.Exception) { std::rethrow_exception(job.Exception); }
+}
+
+bool ThreadPool::RunBatch(Job& job, std::unique_lock<std::mutex>& lock) {
+	if (job.Next >= job.Count) { return false; }
+
+	const size_t begin = job.Next;
+	const size_t end   = std::min(job.Count, begin + job.Batch);
+	job.Next           = end;
+	if (job.Next >= job.Count) { _jobs.erase(std::find(_jobs.begin(), _jobs.end(), &job)); }
+
+	lock.unlock();
+	std::exception_ptr exception;
+	for (size_t i = begin; i < end; ++i) {
+		try {
+			(*job.Func)(i);
+		} catch (...) {
+			if (!exception) { exception = std::current_exception(); }
+		}
+	}
+	lock.lock();
+
+	if (exception && !job.Exception) { job.Exception = exception; }
+	job.Remaining -= end - begin;
+	if (job.Remaining == 0) { _workComplete.notify_all(); }
+
+	return true;
+}
+
+void ThreadPool::WorkerMain() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true) {
+		_workAvailable.wait(lock, [this]() { return _shutdown || !_jobs.empty(); });
+		if (_shutdown) { break; }
+
+		RunBatch(*_jobs.front(), lock);
+	}
+}
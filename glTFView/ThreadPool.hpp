@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+ public:
+	ThreadPool(uint32_t threadCount = std::thread::hardware_concurrency());
+	ThreadPool(const ThreadPool&)            = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool() noexcept;
+
+	static ThreadPool& Get();
+
+	uint32_t GetThreadCount() const {
+		return static_cast<uint32_t>(_threads.size());
+	}
+
+	// Invoke func once for every index in [0, count), spread across the worker threads. The calling thread takes part in
+	// the work and does not return until every index has been processed, so it is safe to call this from within another
+	// ParallelFor. The first exception thrown by func is rethrown on the calling thread.
+	void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+ private:
+	struct Job {
+		const std::function<void(size_t)>* Func = nullptr;
+		size_t Count                            = 0;
+		size_t Batch                            = 1;
+		size_t Next                             = 0;
+		size_t Remaining                        = 0;
+		std::exception_ptr Exception;
+	};
+
+	bool RunBatch(Job& job, std::unique_lock<std::mutex>& lock);
+	void WorkerMain();
+
+	std::vector<std::thread> _threads;
+	std::mutex _mutex;
+	std::condition_variable _workAvailable;
+	std::condition_variable _workComplete;
+	std::deque<Job*> _jobs;
+	bool _shutdown = false;
+};
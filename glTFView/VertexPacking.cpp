@@ -0,0 +1,189 @@
+#include "VertexPacking.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/type_precision.hpp>
+
+#include "Model.hpp"
+
+// Texcoords are stored as half floats unless that would move any of them by more than this. The tolerance is absolute,
+// as an error in UV units is the same fraction of a texel wherever the UV lies: a quarter of a texel of a 1024 texture.
+// Half floats are only that precise within (-1, 1), so a mesh with tiled or atlas UVs outside of it keeps float
+// texcoords, unless every such UV happens to lie on the coarser half float grid.
+static constexpr float MaxTexcoordError = 1.0f / 4096.0f;
+
+static bool HalfIsExact(float value) {
+	const float roundTrip = glm::unpackHalf2x16(glm::packHalf2x16(glm::vec2(value, 0.0f))).x;
+
+	return std::abs(roundTrip - value) <= MaxTexcoordError;
+}
+
+// Map a unit vector onto the octahedron, and the octahedron onto a square. Values are in [-1, 1].
+static glm::vec2 OctEncode(const glm::vec3& n) {
+	const float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+	if (l1 == 0.0f) { return glm::vec2(0.0f); }
+
+	glm::vec2 e(n.x / l1, n.y / l1);
+	if (n.z < 0.0f) {
+		e = glm::vec2((1.0f - std::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f),
+		              (1.0f - std::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f));
+	}
+
+	return e;
+}
+
+static int8_t PackSnorm8(float v) {
+	return static_cast<int8_t>(std::round(glm::clamp(v, -1.0f, 1.0f) * 127.0f));
+}
+
+static uint16_t PackUnorm16(float v) {
+	return static_cast<uint16_t>(std::round(glm::clamp(v, 0.0f, 1.0f) * 65535.0f));
+}
+
+// Quantize weights to 8 bits, keeping their sum at exactly 255 so that skinned vertices do not drift or shrink.
+static glm::u8vec4 PackWeights(const glm::vec4& weights) {
+	const float sum = weights.x + weights.y + weights.z + weights.w;
+	if (sum <= 0.0f) { return glm::u8vec4(0); }
+
+	int quantized[4];
+	int total   = 0;
+	int largest = 0;
+	for (int i = 0; i < 4; ++i) {
+		quantized[i] = static_cast<int>(std::round(glm::clamp(weights[i] / sum, 0.0f, 1.0f) * 255.0f));
+		total += quantized[i];
+		if (quantized[i] > quantized[largest]) { largest = i; }
+	}
+	quantized[largest] += 255 - total;
+
+	return glm::u8vec4(quantized[0], quantized[1], quantized[2], quantized[3]);
+}
+
+static void WriteAttribute(
+	uint8_t* dst, const PackedVertexFormat& format, size_t vertex, VertexInput input, const void* data) {
+	const auto& attribute = format.Attributes[static_cast<uint32_t>(input)];
+	memcpy(dst + attribute.Offset + vertex * attribute.Stride, data, attribute.Size);
+}
+
+static void WriteTexcoord(
+	uint8_t* dst, const PackedVertexFormat& format, size_t vertex, VertexInput input, const glm::vec2& uv) {
+	if (format.Attributes[static_cast<uint32_t>(input)].Format == vk::Format::eR32G32Sfloat) {
+		WriteAttribute(dst, format, vertex, input, glm::value_ptr(uv));
+	} else {
+		const uint32_t packed = glm::packHalf2x16(uv);
+		WriteAttribute(dst, format, vertex, input, &packed);
+	}
+}
+
+PackedVertexLayout ChoosePackedVertexLayout(std::span<const Vertex> vertices) {
+	PackedVertexLayout layout;
+	for (const auto& v : vertices) {
+		if (v.Texcoord1 != glm::vec2(0.0f)) { layout |= PackedVertexLayoutBits::Texcoord1; }
+		if (v.Color0 != glm::vec4(1.0f)) { layout |= PackedVertexLayoutBits::Color0; }
+		if (v.Joints0 != glm::uvec4(0) || v.Weights0 != glm::vec4(0.0f)) { layout |= PackedVertexLayoutBits::Skinned; }
+		if (glm::any(glm::greaterThan(v.Joints0, glm::uvec4(255)))) { layout |= PackedVertexLayoutBits::WideJoints; }
+		if (!(HalfIsExact(v.Texcoord0.x) && HalfIsExact(v.Texcoord0.y) && HalfIsExact(v.Texcoord1.x) &&
+		      HalfIsExact(v.Texcoord1.y))) {
+			layout |= PackedVertexLayoutBits::FloatTexcoords;
+		}
+	}
+
+	return layout;
+}
+
+PackedVertexFormat GetPackedVertexFormat(PackedVertexLayout layout, size_t vertexCount) {
+	PackedVertexFormat format;
+	auto Add = [&format](VertexInput input, vk::Format attributeFormat, uint32_t size) {
+		format.Attributes[static_cast<uint32_t>(input)] = {
+			.Format = attributeFormat, .Offset = format.VertexSize, .Size = size};
+		format.VertexSize += size;
+	};
+
+	const bool floatTexcoords   = bool(layout & PackedVertexLayoutBits::FloatTexcoords);
+	const auto texcoordFormat   = floatTexcoords ? vk::Format::eR32G32Sfloat : vk::Format::eR16G16Sfloat;
+	const uint32_t texcoordSize = floatTexcoords ? 8 : 4;
+
+	Add(VertexInput::Position, vk::Format::eR32G32B32Sfloat, 12);
+	Add(VertexInput::Normal, vk::Format::eR16G16Snorm, 4);
+	Add(VertexInput::Tangent, vk::Format::eR8G8B8A8Snorm, 4);
+	Add(VertexInput::Texcoord0, texcoordFormat, texcoordSize);
+	if (layout & PackedVertexLayoutBits::Texcoord1) { Add(VertexInput::Texcoord1, texcoordFormat, texcoordSize); }
+	if (layout & PackedVertexLayoutBits::Color0) { Add(VertexInput::Color0, vk::Format::eR16G16B16A16Unorm, 8); }
+	if (layout & PackedVertexLayoutBits::Skinned) {
+		if (layout & PackedVertexLayoutBits::WideJoints) {
+			Add(VertexInput::Joints0, vk::Format::eR16G16B16A16Uint, 8);
+		} else {
+			Add(VertexInput::Joints0, vk::Format::eR8G8B8A8Uint, 4);
+		}
+		Add(VertexInput::Weights0, vk::Format::eR8G8B8A8Unorm, 4);
+	}
+
+	// Every value is a multiple of 4 bytes, so each stream of a deinterleaved layout stays aligned.
+	vk::DeviceSize streamOffset = 0;
+	for (auto& attribute : format.Attributes) {
+		if (attribute.Format == vk::Format::eUndefined) { continue; }
+
+		if (layout & PackedVertexLayoutBits::Deinterleaved) {
+			attribute.Offset = streamOffset;
+			attribute.Stride = attribute.Size;
+			streamOffset += vertexCount * attribute.Size;
+		} else {
+			attribute.Stride = format.VertexSize;
+		}
+	}
+
+	return format;
+}
+
+PackedVertexFormat GetDefaultVertexFormat() {
+	PackedVertexFormat format;
+	format.Attributes[static_cast<uint32_t>(VertexInput::Texcoord1)] = {
+		.Format = vk::Format::eR32G32Sfloat, .Offset = offsetof(DefaultVertex, Texcoord1), .Size = sizeof(glm::vec2)};
+	format.Attributes[static_cast<uint32_t>(VertexInput::Color0)] = {
+		.Format = vk::Format::eR32G32B32A32Sfloat, .Offset = offsetof(DefaultVertex, Color0), .Size = sizeof(glm::vec4)};
+	format.Attributes[static_cast<uint32_t>(VertexInput::Joints0)] = {
+		.Format = vk::Format::eR32G32B32A32Uint, .Offset = offsetof(DefaultVertex, Joints0), .Size = sizeof(glm::uvec4)};
+	format.Attributes[static_cast<uint32_t>(VertexInput::Weights0)] = {
+		.Format = vk::Format::eR32G32B32A32Sfloat, .Offset = offsetof(DefaultVertex, Weights0), .Size = sizeof(glm::vec4)};
+
+	return format;
+}
+
+void PackVertices(std::span<const Vertex> vertices, PackedVertexLayout layout, uint8_t* dst) {
+	const auto format = GetPackedVertexFormat(layout, vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		const auto& v = vertices[i];
+		WriteAttribute(dst, format, i, VertexInput::Position, glm::value_ptr(v.Position));
+
+		const uint32_t normal = glm::packSnorm2x16(OctEncode(v.Normal));
+		WriteAttribute(dst, format, i, VertexInput::Normal, &normal);
+
+		const int8_t tangent[4] = {
+			PackSnorm8(v.Tangent.x), PackSnorm8(v.Tangent.y), PackSnorm8(v.Tangent.z), v.Tangent.w < 0.0f ? -127 : 127};
+		WriteAttribute(dst, format, i, VertexInput::Tangent, tangent);
+
+		WriteTexcoord(dst, format, i, VertexInput::Texcoord0, v.Texcoord0);
+		if (layout & PackedVertexLayoutBits::Texcoord1) {
+			WriteTexcoord(dst, format, i, VertexInput::Texcoord1, v.Texcoord1);
+		}
+
+		if (layout & PackedVertexLayoutBits::Color0) {
+			const uint16_t color[4] = {
+				PackUnorm16(v.Color0.r), PackUnorm16(v.Color0.g), PackUnorm16(v.Color0.b), PackUnorm16(v.Color0.a)};
+			WriteAttribute(dst, format, i, VertexInput::Color0, color);
+		}
+
+		if (layout & PackedVertexLayoutBits::Skinned) {
+			if (layout & PackedVertexLayoutBits::WideJoints) {
+				const glm::u16vec4 joints(glm::min(v.Joints0, glm::uvec4(65535)));
+				WriteAttribute(dst, format, i, VertexInput::Joints0, glm::value_ptr(joints));
+			} else {
+				const glm::u8vec4 joints(v.Joints0);
+				WriteAttribute(dst, format, i, VertexInput::Joints0, glm::value_ptr(joints));
+			}
+
+			const glm::u8vec4 weights = PackWeights(v.Weights0);
+			WriteAttribute(dst, format, i, VertexInput::Weights0, glm::value_ptr(weights));
+		}
+	}
+}
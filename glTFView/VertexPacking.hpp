@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Tsuki/Common.hpp>
+#include <Tsuki/EnumClass.hpp>
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+
+struct Vertex;
+
+// The inputs of PBR.vert, by shader location.
+enum class VertexInput : uint32_t {
+	Position,
+	Normal,
+	Tangent,
+	Texcoord0,
+	Texcoord1,
+	Color0,
+	Joints0,
+	Weights0
+};
+constexpr uint32_t VertexInputCount = 8;
+
+// The optional parts of a packed vertex. Anything a mesh does not use is left out of its vertices entirely.
+//
+// Vertices are normally interleaved. A deinterleaved layout instead stores each input in its own tightly packed stream,
+// one after another, so that a pass which only needs some of the inputs (such as positions for depth-only rendering)
+// only fetches those.
+enum class PackedVertexLayoutBits : uint32_t {
+	Texcoord1      = 1 << 0,
+	Color0         = 1 << 1,
+	Skinned        = 1 << 2,
+	WideJoints     = 1 << 3,
+	FloatTexcoords = 1 << 4,
+	Deinterleaved  = 1 << 5
+};
+using PackedVertexLayout = tk::Bitmask<PackedVertexLayoutBits>;
+template <>
+struct tk::EnableBitmaskOperators<PackedVertexLayoutBits> : std::true_type {};
+
+// Where each vertex input lives within a packed vertex.
+//
+// Positions are kept as floats. Normals are octahedral-encoded into two 16-bit snorms, tangents are 8-bit snorms with
+// the bitangent sign in w, texcoords are half floats, colors are 16-bit unorms, joints are 8- or 16-bit integers, and
+// weights are 8-bit unorms. Inputs the layout leaves out have an undefined format. Half float texcoords are only
+// precise enough within (-1, 1), so meshes with tiled or atlas UVs beyond that usually use FloatTexcoords instead.
+//
+// Offset is where the first vertex's value is, and Stride is the distance between consecutive values. VertexSize is the
+// total size of one vertex across every input.
+struct PackedVertexFormat {
+	struct Attribute {
+		vk::Format Format     = vk::Format::eUndefined;
+		vk::DeviceSize Offset = 0;
+		uint32_t Size         = 0;
+		uint32_t Stride       = 0;
+	};
+
+	std::array<Attribute, VertexInputCount> Attributes;
+	uint32_t VertexSize = 0;
+};
+
+// Inputs which a mesh leaves out are read from this instead, bound as a vertex buffer with a stride of zero.
+struct DefaultVertex {
+	glm::vec4 Color0    = glm::vec4(1.0f);
+	glm::uvec4 Joints0  = glm::uvec4(0);
+	glm::vec4 Weights0  = glm::vec4(0.0f);
+	glm::vec2 Texcoord1 = glm::vec2(0.0f);
+};
+
+// Find the smallest layout which can represent every vertex of a mesh without visible loss.
+PackedVertexLayout ChoosePackedVertexLayout(std::span<const Vertex> vertices);
+// The vertex count is needed to place each stream of a deinterleaved layout.
+PackedVertexFormat GetPackedVertexFormat(PackedVertexLayout layout, size_t vertexCount);
+// The format of every optional input within DefaultVertex.
+PackedVertexFormat GetDefaultVertexFormat();
+// Write every vertex in the given layout. dst must hold vertices.size() * VertexSize bytes.
+void PackVertices(std::span<const Vertex> vertices, PackedVertexLayout layout, uint8_t* dst);
@@ -0,0 +1,93 @@
+#include "VertexWelder.hpp"
+
+#include <bit>
+#include <cstring>
+#include <limits>
+
+#include "Model.hpp"
+
+// Every member of Vertex is 4-byte aligned and 4 bytes per component, so its bytes uniquely represent its value.
+static_assert(sizeof(Vertex) == 104, "Vertex must not contain any padding");
+static_assert(sizeof(Vertex) % sizeof(uint64_t) == 0);
+
+static constexpr uint32_t EmptySlot = std::numeric_limits<uint32_t>::max();
+
+struct WeldSlot {
+	uint32_t Index = EmptySlot;
+	uint32_t Hash  = 0;
+};
+
+static uint64_t HashVertex(const Vertex& vertex) {
+	constexpr size_t wordCount = sizeof(Vertex) / sizeof(uint64_t);
+	uint64_t words[wordCount];
+	memcpy(words, &vertex, sizeof(Vertex));
+
+	uint64_t h = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < wordCount; ++i) { h = std::rotl((h ^ words[i]) * 0x9e3779b97f4a7c15ull, 31); }
+
+	// Finalize, so that both halves of the hash depend on every bit of the vertex.
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+
+	return h;
+}
+
+// Put a vertex into a form where equal vertices have equal bytes.
+static void CanonicalizeVertex(Vertex& vertex, float positionTolerance) {
+	if (positionTolerance > 0.0f) {
+		vertex.Position = glm::round(vertex.Position / positionTolerance) * positionTolerance;
+	}
+
+	// Adding zero turns -0.0 into 0.0, which compare equal but have different bytes.
+	vertex.Position += 0.0f;
+	vertex.Normal += 0.0f;
+	vertex.Tangent += 0.0f;
+	vertex.Texcoord0 += 0.0f;
+	vertex.Texcoord1 += 0.0f;
+	vertex.Color0 += 0.0f;
+	vertex.Weights0 += 0.0f;
+}
+
+uint32_t WeldVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float positionTolerance) {
+	const size_t vertexCount = vertices.size();
+	indices.resize(vertexCount);
+	if (vertexCount == 0) { return 0; }
+
+	// Keep the table at most half full, so probe sequences stay short.
+	const size_t tableSize = std::bit_ceil(std::max<size_t>(vertexCount * 2, 16));
+	const size_t tableMask = tableSize - 1;
+	std::vector<WeldSlot> table(tableSize);
+
+	// Unique vertices are moved down to the front of the list as they're found. The write position never passes the read
+	// position, so this can be done in place.
+	uint32_t uniqueCount = 0;
+	for (size_t i = 0; i < vertexCount; ++i) {
+		Vertex vertex = vertices[i];
+		CanonicalizeVertex(vertex, positionTolerance);
+
+		const uint64_t hash     = HashVertex(vertex);
+		const uint32_t slotHash = static_cast<uint32_t>(hash >> 32);
+		size_t slot             = hash & tableMask;
+		while (true) {
+			WeldSlot& entry = table[slot];
+			if (entry.Index == EmptySlot) {
+				entry.Index           = uniqueCount;
+				entry.Hash            = slotHash;
+				vertices[uniqueCount] = vertex;
+				indices[i]            = uniqueCount++;
+				break;
+			}
+			if (entry.Hash == slotHash && memcmp(&vertices[entry.Index], &vertex, sizeof(Vertex)) == 0) {
+				indices[i] = entry.Index;
+				break;
+			}
+			slot = (slot + 1) & tableMask;
+		}
+	}
+	vertices.resize(uniqueCount);
+
+	return uniqueCount;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct Vertex;
+
+// Merge identical vertices together, compacting the vertex list in place and writing an index for every original
+// vertex. Vertices are compared by their exact contents, with a single hash over the whole vertex and an open
+// addressing table sized up front, so no allocations are made per vertex.
+//
+// If positionTolerance is greater than zero, vertex positions are first snapped to a grid of that size, allowing
+// vertices which differ only by tiny amounts of position noise to be merged. Returns the number of unique vertices.
+uint32_t WeldVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float positionTolerance = 0.0f);
@@ -7,11 +7,14 @@
 #include <iostream>
 #include <memory>
 
+#include "Animator.hpp"
 #include "Camera.hpp"
 #include "Environment.hpp"
 #include "Files.hpp"
 #include "IconsFontAwesome6.h"
 #include "Model.hpp"
+#include "ModelLoader.hpp"
+#include "VertexPacking.hpp"
 
 template <typename T>
 class PerFrameBuffer {
@@ -103,6 +106,28 @@ struct PushConstant {
 	uint32_t Skinned = 0;
 };
 
+static void DrawLoadProfileStage(const LoadProfileStage& stage) {
+	ImGui::TableNextRow();
+	ImGui::TableNextColumn();
+	ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth;
+	if (stage.Children.empty()) { flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen; }
+	const bool open = ImGui::TreeNodeEx(&stage, flags, "%s", stage.Name.c_str());
+	if (!stage.Note.empty() && ImGui::IsItemHovered()) { ImGui::SetTooltip("%s", stage.Note.c_str()); }
+	ImGui::TableNextColumn();
+	ImGui::Text("%.2f ms", stage.Time * 1000.0);
+	ImGui::TableNextColumn();
+	if (stage.Count > 0) { ImGui::Text("%llu", static_cast<unsigned long long>(stage.Count)); }
+	ImGui::TableNextColumn();
+	if (stage.Bytes > 0) { ImGui::Text("%.2f MiB", stage.Bytes / (1024.0 * 1024.0)); }
+	ImGui::TableNextColumn();
+	if (stage.Throughput() > 0.0) { ImGui::Text("%.1f MiB/s", stage.Throughput() / (1024.0 * 1024.0)); }
+
+	if (open && !stage.Children.empty()) {
+		for (const auto& child : stage.Children) { DrawLoadProfileStage(child); }
+		ImGui::TreePop();
+	}
+}
+
 int main(int argc, const char** argv) {
 	auto wsi     = std::make_unique<tk::WSI>(std::make_unique<tk::GlfwPlatform>());
 	auto imgui   = std::make_unique<tk::ImGuiRenderer>(*wsi);
@@ -195,6 +220,7 @@ int main(int argc, const char** argv) {
 	tk::ImageHandle blackImage            = {};
 	tk::ImageHandle whiteImage            = {};
 	tk::BufferHandle defaultJointMatrices = {};
+	tk::BufferHandle defaultVertex        = {};
 
 	// Default Images
 	{
@@ -235,7 +261,13 @@ int main(int argc, const char** argv) {
 		defaultJointMatrices = device.CreateBuffer(
 			tk::BufferCreateInfo(tk::BufferDomain::Device, sizeof(glm::mat4), vk::BufferUsageFlagBits::eStorageBuffer),
 			&jointMatrix);
+
+		const DefaultVertex vertex;
+		defaultVertex = device.CreateBuffer(
+			tk::BufferCreateInfo(tk::BufferDomain::Device, sizeof(DefaultVertex), vk::BufferUsageFlagBits::eVertexBuffer),
+			&vertex);
 	}
+	const PackedVertexFormat defaultVertexFormat = GetDefaultVertexFormat();
 
 	PerFrameBuffer<SceneUBO> sceneBuffers(*wsi);
 	PerFrameImage sceneImages(
@@ -257,20 +289,23 @@ int main(int argc, const char** argv) {
 		if (action == tk::InputAction::Press && key == tk::Key::F5) { LoadShaders(); }
 	};
 
-	bool showSkeleton = false;
+	bool showSkeleton     = false;
+	bool cullMeshlets     = true;
+	bool useLods          = true;
+	float lodPixelError   = 1.0f;
+	size_t meshletsDrawn  = 0;
+	size_t meshletsTotal  = 0;
+	size_t trianglesDrawn = 0;
+	// Models are loaded in the background, and the current model keeps being drawn until the new one is ready.
 	std::unique_ptr<Model> model;
-	auto LoadModel = [&](const std::filesystem::path& gltfPath) {
-		try {
-			std::cout << "Loading glTF model " << gltfPath.string() << std::endl;
-			auto newModel = std::make_unique<Model>(wsi->GetDevice(), gltfPath);
-			model         = std::move(newModel);
-			for (auto& texture : model->Textures) {
-				texture->BoundIndex = nextBindless++;
-				bindlessImages->SetTexture(texture->BoundIndex, *texture->Image->Image->GetView());
-			}
-		} catch (const std::exception& e) {
-			std::cerr << "Failed to load model from '" << gltfPath.string() << "': " << e.what() << std::endl;
-			return;
+	ModelLoader modelLoader(device);
+	std::unique_ptr<Animator> animator;
+	auto UseModel = [&](std::unique_ptr<Model> newModel) {
+		model    = std::move(newModel);
+		animator = std::make_unique<Animator>(*model);
+		for (auto& texture : model->Textures) {
+			texture->BoundIndex = nextBindless++;
+			bindlessImages->SetTexture(texture->BoundIndex, *texture->Image->Image->GetView());
 		}
 
 		model->ActiveAnimation = 0;
@@ -279,15 +314,15 @@ int main(int argc, const char** argv) {
 		glm::vec3 modelTrans = -glm::vec3(model->AABB[3]);
 		modelTrans += -0.5f * glm::vec3(model->AABB[0][0], model->AABB[1][1], model->AABB[2][2]);
 		for (auto* node : model->RootNodes) {
-			node->Translation += modelTrans * modelScale;
-			node->AnimTranslation += modelTrans * modelScale;
-			node->Scale *= modelScale;
-			node->AnimScale *= modelScale;
+			node->SetTranslation(node->Translation + modelTrans * modelScale);
+			node->SetAnimTranslation(node->AnimTranslation + modelTrans * modelScale);
+			node->SetScale(node->Scale * modelScale);
+			node->SetAnimScale(node->AnimScale * modelScale);
 		}
 		camera.SetPosition({0, 0, 1});
 		camera.SetRotation({0, 0, 0});
 	};
-	LoadModel("Assets/Models/Fox/Fox.gltf");
+	modelLoader.Load("Assets/Models/Fox/Fox.gltf");
 
 	std::unique_ptr<Environment> environment;
 	auto LoadEnvironment = [&](const std::filesystem::path& envPath) {
@@ -303,7 +338,7 @@ int main(int argc, const char** argv) {
 	tk::Input::OnFilesDropped += [&](const std::vector<std::filesystem::path>& paths) {
 		const auto& file = paths[0];
 		if (file.extension() == ".gltf" || file.extension() == ".glb") {
-			LoadModel(file);
+			modelLoader.Load(file);
 		} else if (file.extension() == ".hdr") {
 			LoadEnvironment(file);
 		}
@@ -316,6 +351,10 @@ int main(int argc, const char** argv) {
 		const auto frameIndex = device.GetFrameIndex();
 		const double time     = wsi->GetTime();
 
+		if (auto loadedModel = modelLoader.TakeModel()) { UseModel(std::move(loadedModel)); }
+		// Animate before recording anything, so that every node's transform is final by the time the scene is drawn.
+		if (animator) { animator->Update(time); }
+
 		auto cmd = device.RequestCommandBuffer();
 
 		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
@@ -410,22 +449,12 @@ int main(int argc, const char** argv) {
 			                tk::StockSampler::LinearClamp);
 			cmd->SetTexture(
 				0, 3, environment ? *environment->BrdfLut->GetView() : *blackImage->GetView(), tk::StockSampler::LinearClamp);
-			cmd->SetVertexAttribute(0, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, Position));
-			cmd->SetVertexAttribute(1, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, Normal));
-			cmd->SetVertexAttribute(2, 0, vk::Format::eR32G32B32A32Sfloat, offsetof(Vertex, Tangent));
-			cmd->SetVertexAttribute(3, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, Texcoord0));
-			cmd->SetVertexAttribute(4, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, Texcoord1));
-			cmd->SetVertexAttribute(5, 0, vk::Format::eR32G32B32A32Sfloat, offsetof(Vertex, Color0));
-			cmd->SetVertexAttribute(6, 0, vk::Format::eR32G32B32A32Uint, offsetof(Vertex, Joints0));
-			cmd->SetVertexAttribute(7, 0, vk::Format::eR32G32B32A32Sfloat, offsetof(Vertex, Weights0));
 
 			std::function<void(const Model&, const Node*)> DrawBone = [&](const Model& model, const Node* node) {
 				if (!node->Children.empty()) {
-					const auto startTransform = model.Animate ? node->GetAnimGlobalTransform() : node->GetGlobalTransform();
-					const glm::vec3 start     = startTransform[3];
+					const glm::vec3 start = model.GetDrawTransform(node)[3];
 					for (const auto* child : node->Children) {
-						const auto endTransform = model.Animate ? child->GetAnimGlobalTransform() : child->GetGlobalTransform();
-						const glm::vec3 end     = endTransform[3];
+						const glm::vec3 end = model.GetDrawTransform(child)[3];
 
 						DrawLine(start, end);
 						DrawBone(model, child);
@@ -433,12 +462,17 @@ int main(int argc, const char** argv) {
 				}
 			};
 
+			const glm::vec3 cameraPosition = glm::inverse(sceneData.View)[3];
+			meshletsDrawn                  = 0;
+			meshletsTotal                  = 0;
+			trianglesDrawn                 = 0;
+
 			std::function<void(Model&, const Node*)> IterateNode = [&](Model& model, const Node* node) {
 				if (node->Mesh) {
 					const auto mesh      = node->Mesh;
 					const auto skinId    = node->Skin;
 					const auto* skin     = skinId >= 0 ? model.Skins[skinId].get() : nullptr;
-					pushConstant.Node    = model.Animate ? node->GetAnimGlobalTransform() : node->GetGlobalTransform();
+					pushConstant.Node    = model.GetDrawTransform(node);
 					pushConstant.Skinned = skin ? 1 : 0;
 
 					if (skin) {
@@ -447,19 +481,48 @@ int main(int argc, const char** argv) {
 						glm::mat4* jointMatrices     = reinterpret_cast<glm::mat4*>(skin->Buffer->Map());
 
 						for (size_t i = 0; i < jointCount; ++i) {
-							const auto jointMat =
-								model.Animate ? skin->Joints[i]->GetAnimGlobalTransform() : skin->Joints[i]->GetGlobalTransform();
-							jointMatrices[i] = jointMat * skin->InverseBindMatrices[i];
+							jointMatrices[i] = model.GetDrawTransform(skin->Joints[i]) * skin->InverseBindMatrices[i];
 							jointMatrices[i] = invTransform * jointMatrices[i];
 						}
 
 						if (showSkeleton) { DrawBone(model, skin->RootNode); }
 					}
 
-					cmd->SetVertexBinding(0, *mesh->Buffer, 0, sizeof(Vertex), vk::VertexInputRate::eVertex);
+					// Every vertex input has its own binding, so that a mesh can lay its attributes out however it likes. Inputs
+					// the mesh does not store are read from the default vertex instead.
+					const VertexAttribute* attributes[VertexInputCount] = {&mesh->Position,
+					                                                       &mesh->Normal,
+					                                                       &mesh->Tangent,
+					                                                       &mesh->Texcoord0,
+					                                                       &mesh->Texcoord1,
+					                                                       &mesh->Color0,
+					                                                       &mesh->Joints0,
+					                                                       &mesh->Weights0};
+					for (uint32_t i = 0; i < VertexInputCount; ++i) {
+						const auto* attribute = attributes[i];
+						if (attribute->Format == vk::Format::eUndefined) {
+							const auto& defaultAttribute = defaultVertexFormat.Attributes[i];
+							cmd->SetVertexAttribute(i, i, defaultAttribute.Format, 0);
+							cmd->SetVertexBinding(i, *defaultVertex, defaultAttribute.Offset, 0, vk::VertexInputRate::eVertex);
+						} else {
+							cmd->SetVertexAttribute(i, i, attribute->Format, 0);
+							cmd->SetVertexBinding(
+								i, *mesh->Buffer, attribute->Offset, attribute->Stride, vk::VertexInputRate::eVertex);
+						}
+					}
 					cmd->SetStorageBuffer(1, 0, skin ? *skin->Buffer : *defaultJointMatrices);
+
+					// Meshlets are culled in the mesh's own space. Skinned meshes move away from their meshlets' bounds, so they
+					// are never culled, and the normal cones of mirrored meshes face the wrong way.
+					const bool cullNode        = cullMeshlets && !skin;
+					const bool cullBackfacing  = glm::determinant(glm::mat3(pushConstant.Node)) > 0.0f;
+					const Frustum nodeFrustum  = Frustum(sceneData.ViewProjection * pushConstant.Node);
+					const glm::vec3 nodeViewer = glm::inverse(pushConstant.Node) * glm::vec4(cameraPosition, 1.0f);
+					const float nodeScale      = std::max({glm::length(glm::vec3(pushConstant.Node[0])),
+					                                       glm::length(glm::vec3(pushConstant.Node[1])),
+					                                       glm::length(glm::vec3(pushConstant.Node[2]))});
 					if (mesh->TotalIndexCount > 0) {
-						cmd->SetIndexBuffer(*mesh->Buffer, mesh->IndexOffset, vk::IndexType::eUint32);
+						cmd->SetIndexBuffer(*mesh->Buffer, mesh->IndexOffset, mesh->IndexType);
 					}
 
 					const size_t submeshCount = mesh->Submeshes.size();
@@ -502,10 +565,57 @@ int main(int argc, const char** argv) {
 						cmd->SetCullMode(material->Sidedness == Sidedness::Both ? vk::CullModeFlagBits::eNone
 						                                                        : vk::CullModeFlagBits::eBack);
 
+						// Pick the coarsest level of detail whose error, projected onto the screen, stays within the threshold.
+						size_t lodLevel = 0;
+						if (useLods && submesh.Lods.size() > 1 && submesh.Bounds.Valid) {
+							const glm::vec3 boundsCenter = (submesh.Bounds.Min + submesh.Bounds.Max) * 0.5f;
+							const glm::vec3 center       = pushConstant.Node * glm::vec4(boundsCenter, 1.0f);
+							const float size             = glm::length(submesh.Bounds.Max - submesh.Bounds.Min) * nodeScale;
+							const float distance         = glm::distance(center, cameraPosition) - size * 0.5f;
+							if (distance > 0.0f) {
+								// The height of the bounds' diagonal on screen, in pixels.
+								const float projectedSize = size * sceneData.Projection[1][1] * 0.5f * viewportSize.y / distance;
+								while (lodLevel + 1 < submesh.Lods.size() &&
+								       submesh.Lods[lodLevel + 1].Error * projectedSize <= lodPixelError) {
+									++lodLevel;
+								}
+							}
+						}
+
 						if (submesh.IndexCount == 0) {
 							cmd->Draw(submesh.VertexCount, 1, submesh.FirstVertex, 0);
-						} else {
+							trianglesDrawn += submesh.VertexCount / 3;
+						} else if (lodLevel > 0) {
+							const auto& lod = submesh.Lods[lodLevel];
+							cmd->DrawIndexed(lod.IndexCount, 1, lod.FirstIndex, submesh.FirstVertex, 0);
+							trianglesDrawn += lod.IndexCount / 3;
+						} else if (!cullNode || submesh.MeshletCount == 0) {
 							cmd->DrawIndexed(submesh.IndexCount, 1, submesh.FirstIndex, submesh.FirstVertex, 0);
+							trianglesDrawn += submesh.IndexCount / 3;
+						} else {
+							// The meshlets of a submesh are contiguous in its index buffer, so each run of consecutive visible
+							// meshlets can be drawn at once.
+							const bool cullMeshletBackfacing = cullBackfacing && material->Sidedness != Sidedness::Both;
+							uint32_t runFirst                = 0;
+							uint32_t runCount                = 0;
+							for (uint32_t m = 0; m < submesh.MeshletCount; ++m) {
+								const auto& meshlet = mesh->Meshlets[submesh.FirstMeshlet + m];
+								const bool visible  = nodeFrustum.Intersects(meshlet.Center, meshlet.Radius) &&
+								                     !(cullMeshletBackfacing && IsMeshletBackfacing(meshlet, nodeViewer));
+								if (visible) {
+									if (runCount == 0) { runFirst = meshlet.FirstIndex; }
+									runCount += meshlet.IndexCount;
+									trianglesDrawn += meshlet.IndexCount / 3;
+									++meshletsDrawn;
+								} else if (runCount > 0) {
+									cmd->DrawIndexed(runCount, 1, submesh.FirstIndex + runFirst, submesh.FirstVertex, 0);
+									runCount = 0;
+								}
+							}
+							if (runCount > 0) {
+								cmd->DrawIndexed(runCount, 1, submesh.FirstIndex + runFirst, submesh.FirstVertex, 0);
+							}
+							meshletsTotal += submesh.MeshletCount;
 						}
 					}
 				}
@@ -514,83 +624,6 @@ int main(int argc, const char** argv) {
 			};
 
 			auto RenderModel = [&](Model& model) {
-				if (model.ActiveAnimation < model.Animations.size()) {
-					auto& animation           = model.Animations[model.ActiveAnimation];
-					const float animationTime = std::fmod(time, animation->EndTime);
-
-					for (const auto& channel : animation->Channels) {
-						const auto& sampler = animation->Samplers[channel.Sampler];
-						if (sampler.Interpolation == AnimationInterpolation::CubicSpline) { continue; }
-
-						for (size_t i = 0; i < sampler.Inputs.size() - 1; ++i) {
-							if ((animationTime >= sampler.Inputs[i]) && (animationTime <= sampler.Inputs[i + 1])) {
-								const float t = (animationTime - sampler.Inputs[i]) / (sampler.Inputs[i + 1] - sampler.Inputs[i]);
-								switch (channel.Path) {
-									case AnimationPath::Translation: {
-										switch (sampler.Interpolation) {
-											case AnimationInterpolation::Linear:
-												channel.Target->AnimTranslation = glm::mix(sampler.Outputs[i], sampler.Outputs[i + 1], t);
-												break;
-
-											case AnimationInterpolation::Step:
-												channel.Target->AnimTranslation = sampler.Outputs[i];
-												break;
-
-											default:
-												break;
-										}
-									} break;
-
-									case AnimationPath::Rotation: {
-										glm::quat q1;
-										q1.x = sampler.Outputs[i].x;
-										q1.y = sampler.Outputs[i].y;
-										q1.z = sampler.Outputs[i].z;
-										q1.w = sampler.Outputs[i].w;
-
-										glm::quat q2;
-										q2.x = sampler.Outputs[i + 1].x;
-										q2.y = sampler.Outputs[i + 1].y;
-										q2.z = sampler.Outputs[i + 1].z;
-										q2.w = sampler.Outputs[i + 1].w;
-
-										switch (sampler.Interpolation) {
-											case AnimationInterpolation::Linear:
-												channel.Target->AnimRotation = glm::normalize(glm::slerp(q1, q2, t));
-												break;
-
-											case AnimationInterpolation::Step:
-												channel.Target->AnimRotation = q1;
-												break;
-
-											default:
-												break;
-										}
-									} break;
-
-									case AnimationPath::Scale: {
-										switch (sampler.Interpolation) {
-											case AnimationInterpolation::Linear:
-												channel.Target->AnimScale = glm::mix(sampler.Outputs[i], sampler.Outputs[i + 1], t);
-												break;
-
-											case AnimationInterpolation::Step:
-												channel.Target->AnimScale = sampler.Outputs[i];
-												break;
-
-											default:
-												break;
-										}
-									} break;
-
-									default:
-										break;
-								}
-							}
-						}
-					}
-				}
-
 				for (const auto* node : model.RootNodes) { IterateNode(model, node); }
 			};
 			if (model) { RenderModel(*model); }
@@ -636,6 +669,11 @@ int main(int argc, const char** argv) {
 		}
 
 		if (ImGui::Begin("glTF Model")) {
+			if (modelLoader.IsLoading()) {
+				const auto& progress = modelLoader.GetProgress();
+				ImGui::Text("Loading: %s", modelLoader.GetLoadingPath().filename().string().c_str());
+				ImGui::ProgressBar(progress.GetFraction(), ImVec2(-1.0f, 0.0f), progress.StepName.load());
+			}
 			if (model) {
 				ImGui::Text("Model: %s", model->Name.c_str());
 
@@ -658,6 +696,38 @@ int main(int argc, const char** argv) {
 				}
 
 				ImGui::Checkbox("Show Skeletons", &showSkeleton);
+				ImGui::Checkbox("Cull Meshlets", &cullMeshlets);
+				if (cullMeshlets) { ImGui::Text("Meshlets Drawn: %zu / %zu", meshletsDrawn, meshletsTotal); }
+				ImGui::Checkbox("Use LODs", &useLods);
+				if (useLods) { ImGui::SliderFloat("LOD Pixel Error", &lodPixelError, 0.25f, 16.0f); }
+				ImGui::Text("Triangles Drawn: %zu", trianglesDrawn);
+
+				if (ImGui::CollapsingHeader("Load Profile")) {
+					const auto& profile = model->LoadProfile;
+					if (ImGui::Button("Export JSON")) {
+						const auto jsonPath =
+							std::filesystem::path("Profiles") / std::filesystem::path(profile.SourcePath).stem().concat(".json");
+						try {
+							profile.SaveJson(jsonPath);
+							std::cout << "Load profile saved to '" << jsonPath.string() << "'." << std::endl;
+						} catch (const std::exception& e) {
+							std::cerr << "Failed to save load profile to '" << jsonPath.string() << "': " << e.what() << std::endl;
+						}
+					}
+
+					const ImGuiTableFlags tableFlags = ImGuiTableFlags_BordersV | ImGuiTableFlags_RowBg |
+					                                   ImGuiTableFlags_Resizable | ImGuiTableFlags_NoBordersInBody;
+					if (ImGui::BeginTable("LoadProfile", 5, tableFlags)) {
+						ImGui::TableSetupColumn("Stage", ImGuiTableColumnFlags_NoHide);
+						ImGui::TableSetupColumn("Time");
+						ImGui::TableSetupColumn("Count");
+						ImGui::TableSetupColumn("Data");
+						ImGui::TableSetupColumn("Throughput");
+						ImGui::TableHeadersRow();
+						DrawLoadProfileStage(profile.Total);
+						ImGui::EndTable();
+					}
+				}
 			} else {
 				ImGui::Text("No Model Loaded...");
 			}